@@ -0,0 +1,100 @@
+// Advancing of agents' positions: the walk over the states of `mapf_r` agents,
+// as `doStepAdvanceAgs` did, compared to the structure-of-arrays kernel of `Motion`.
+// Usage: bench_motion [<n_agents> ...]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "mapf_r/agent/layout.hpp"
+#include "mapf_r/agent/plan.hpp"
+
+#include "../include/motion.hpp"
+#include "../include/timeline_io.hpp"
+
+using namespace std;
+
+static constexpr float step = 0.001;
+// the actions are long enough not to end during the benchmark
+static constexpr float duration = 1e6;
+
+// a single long move of each agent, as a `.stp` file
+static string make_plan_text(long n, mt19937& gen)
+{
+  uniform_real_distribution<float> dist(0, 100);
+
+  ostringstream oss;
+  oss << n << '\n';
+  for (long i = 0; i < n; ++i) {
+    oss << i << ' ' << 0.5 << ' ' << 1 << ' ' << 1 << '\n';
+    oss << dist(gen) << ' ' << dist(gen) << ' ' << dist(gen) << ' ' << dist(gen) << ' ' << duration << '\n';
+  }
+  return oss.str();
+}
+
+template <typename F>
+static double measure_ns(F f, long n_agents)
+{
+  using Clock = chrono::steady_clock;
+  // roughly the same total amount of work for all sizes
+  const long n_iters = max(10L, 100'000'000L/n_agents);
+  f();
+  const auto start = Clock::now();
+  for (long i = 0; i < n_iters; ++i) f();
+  const chrono::duration<double, nano> elapsed = Clock::now() - start;
+  return elapsed.count()/n_iters/n_agents;
+}
+
+static void run(long n)
+{
+  mt19937 gen(n);
+  istringstream iss(make_plan_text(n, gen));
+  agent::plan::Global_states splan(iss);
+
+  // the same as the agents of the app used to be set
+  Agents agents;
+  agents.reserve(n);
+  for (long i = 0; i < n; ++i) {
+    agent::Id aid = i;
+    auto& states = splan.cat(aid);
+    agents.emplace_back(aid, states.radius, states.abs_v, states.front().cpos());
+    agents.back().state() = states.front();
+  }
+
+  const Timeline timeline = make_timeline(splan);
+  Motion motion;
+  motion.resize(n);
+  for (long i = 0; i < n; ++i) motion.set(i, timeline.ctrack(i), 0, 0);
+
+  const double aos_ns = measure_ns([&]{
+    for (auto& ag : agents) ag.state().advance(step);
+  }, n);
+
+  Motion::parallel_min_size = numeric_limits<Motion::Idx>::max();
+  const double soa_ns = measure_ns([&]{ motion.advance(step); }, n);
+
+  Motion::parallel_min_size = 0;
+  const double soa_par_ns = measure_ns([&]{ motion.advance(step); }, n);
+
+  printf("%8ld %12.3f %12.3f %12.3f %10.2fx %10.2fx\n", n, aos_ns, soa_ns, soa_par_ns,
+         aos_ns/soa_ns, aos_ns/soa_par_ns);
+}
+
+int main(int argc, char* argv[])
+{
+  printf("%8s %12s %12s %12s %11s %11s\n", "agents", "aos[ns/ag]", "soa[ns/ag]", "par[ns/ag]",
+         "soa-speedup", "par-speedup");
+
+  if (argc < 2) {
+    for (long n : {1'000L, 10'000L, 100'000L}) run(n);
+    return 0;
+  }
+
+  for (int i = 1; i < argc; ++i) run(stol(argv[i]));
+  return 0;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+// Benchmarks of the whole visualizer on synthetic grid graphs and plans of states
+// of agents moving on them, from hundreds to a hundred thousand agents,
+// loaded from text the same as the given files.
+// The results are written as CSV, one line per benchmark and size.
+namespace bench {
+  // drawing is measured only if `with_draw`, it requires a window
+  int run(const std::string& output, bool with_draw);
+}
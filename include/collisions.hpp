@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Pairs of agents whose discs overlap, in expected O(n) time:
+// the agents are hashed into a uniform grid with cells not smaller than
+// the largest diameter, so only the agents in the neighboring cells are tested exactly.
+struct Collisions {
+  using Idx = std::size_t;
+
+  // touching discs within this relative tolerance do not collide
+  static constexpr float tolerance = 1e-4;
+
+  // with `i < j`, sorted
+  std::vector<std::pair<Idx, Idx>> pairs{};
+  // per agent
+  std::vector<bool> colliding{};
+
+  bool empty() const { return pairs.empty(); }
+
+  void detect(std::span<const float> x, std::span<const float> y, std::span<const float> radii);
+
+  // the grid, reused between calls
+  struct Cell { int32_t x, y; bool operator==(const Cell&) const = default; };
+  std::vector<Cell> cells{};
+  std::vector<uint32_t> bucket_begin{};
+  std::vector<uint32_t> bucket_items{};
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Files watched for changes with inotify, through their directories,
+// so that also the files replaced by renaming are noticed.
+// Only finished writes count, not every partial write of the file.
+struct File_watch {
+  File_watch() = default;
+  ~File_watch();
+  File_watch(const File_watch&) = delete;
+  File_watch& operator=(const File_watch&) = delete;
+
+  bool is_open() const { return fd >= 0; }
+
+  void open();
+  void close();
+
+  // returns the index of the file
+  std::size_t add(const std::string& path);
+
+  // indices of the files changed since the last call, never blocks
+  std::vector<std::size_t> poll();
+
+  struct File {
+    // watch descriptor of the directory
+    int wd;
+    std::string name;
+  };
+  std::vector<File> files{};
+  int fd{-1};
+};
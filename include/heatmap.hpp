@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "timeline.hpp"
+
+// Occupancy of the plane by the agents over time:
+// each cell accumulates the time for which its center was covered by some agent.
+// It is updated incrementally by the steps of the playback,
+// or over the whole timeline at once.
+struct Heatmap {
+  float min_x{}, min_y{};
+  float cell_size{1};
+  int width{}, height{};
+  // row-major, from `min_y` up
+  std::vector<float> heat{};
+  float max_heat{};
+
+  bool empty() const { return heat.empty(); }
+
+  // covers the given bounds with at most `max_cells` cells along the longer side
+  void setup(float min_x, float min_y, float max_x, float max_y, int max_cells);
+  void clear();
+
+  void add(float x, float y, float radius, float dt);
+  // all agents in their positions during `dt`
+  void add(std::span<const float> x, std::span<const float> y,
+           std::span<const float> radii, float dt);
+  // sampled by `step`, until the makespan
+  void add(const Timeline&, float step);
+};
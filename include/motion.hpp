@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "timeline.hpp"
+
+// Positions of all agents within their current actions,
+// in a structure-of-arrays layout for vectorized advancing.
+// The position is derived from the remaining time of the action,
+// so it ends up exactly at the end position without accumulating errors.
+struct Motion {
+  using Idx = std::size_t;
+
+  // below this number of agents, the threads would only add overhead
+  inline static Idx parallel_min_size = 1 << 14;
+
+  std::vector<float> end_x{}, end_y{};
+  std::vector<float> vel_x{}, vel_y{};
+  std::vector<float> dt{};
+
+  std::vector<float> x{}, y{};
+
+  Idx size() const { return x.size(); }
+  bool empty() const { return x.empty(); }
+
+  void resize(Idx);
+
+  // sets the action `idx` of `track` to agent `i` at time `t`
+  void set(Idx i, const Timeline::Track& track, Idx idx, float t);
+
+  void advance(float step);
+};
@@ -10,6 +10,17 @@
 
 #include "ofxGifEncoder.h"
 
+#include "timeline.hpp"
+#include "playback.hpp"
+#include "timeline_stream.hpp"
+#include "plan_socket.hpp"
+#include "file_watch.hpp"
+#include "progress_log.hpp"
+#include "video_pipe.hpp"
+#include "vector_image.hpp"
+#include "heatmap.hpp"
+#include "profiler.hpp"
+
 using namespace mapf_r;
 
 struct ofApp : ofBaseApp {
@@ -28,26 +39,74 @@ struct ofApp : ofBaseApp {
   const double line_width = vertex_rad/2;
   const int font_size = max(int(scale/8), 6);
 
-  const agent::plan::Global plan;
+  const agent::Layout* layout_l{};
+  agent::plan::Global plan;
+  // of `plan`, see `statesPlan`
   agent::plan::Global_states states_plan;
   Agents agents{};
+  // of all the plans
   float makespan{};
   static constexpr float t_inf = limits<float>::infinity();
-  float first_switch_time_threshold{t_inf};
+  // the earliest of all the playbacks
   float switch_time_threshold{t_inf};
   float _time_threshold{t_inf};
-  Vector<Idx> agents_action_idx{};
+  // of the same agents on the same graph, side by side with a common clock;
+  // the first one is of `plan` or of the other given plan
+  Vector<Playback> playbacks{Playback{}};
+  Playback& playback() { return playbacks.front(); }
+  const Playback& playback() const { return playbacks.front(); }
+  float curr_time{};
+
+  Profiler profiler{};
+  // windowed streaming of plans that do not fit in memory
+  unique_ptr<Timeline_stream> stream_l{};
+  float stream_window_begin{};
+  float stream_window_end{t_inf};
 
   bool finished{};
 
+  // live plan of the first playback, extended while playing
+  Plan_socket plan_socket{};
+  Vector<Plan_socket::Append> plan_appends{};
+
+  // the plan is reloaded whenever its files change, the graph only on restart
+  string graph_fn{};
+  string layout_fn{};
+  string plan_fn{};
+  File_watch file_watch{};
+  // once reloaded
+  unique_ptr<agent::Layout> layout_ptr{};
+
+  // plan being solved in the background, swapped in once available
+  std::future<agent::plan::Global> pending_plan{};
+  shared_ptr<const Progress_log> solve_log_l{};
+
   bool recording_may_start{};
 
+  // offline rendering, without a visible window and user interaction
+  struct Render_config {
+    string output{};
+    float fps{30};
+    float speed{0.05};
+    // of interactive recordings, `gif` or any supported by `Video_pipe`
+    string format{"gif"};
+    // renders only the `chunk`-th of `n_chunks` equal parts of the frames
+    int chunk{0};
+    int n_chunks{1};
+  };
+  Render_config render_config{};
+
+  // the whole states plan is printed only on demand, `-` is the standard output
+  string plan_dump_output{};
+
   // flg
   bool flg_autoplay{false};
   bool flg_loop{false};
   bool flg_goal{true};
   bool flg_font{false};
-  bool flg_screenshot{false};
+  bool flg_collisions{false};
+  bool flg_collision_pause{false};
+  bool flg_heatmap{false};
   bool flg_record{false};
 
   enum struct LINE_MODE { STRAIGHT, PATH, NONE, NUM };
@@ -59,15 +118,99 @@ struct ofApp : ofBaseApp {
   // gui
   ofxFloatSlider timestep_slider;
   ofxFloatSlider speed_slider;
+  ofxLabel solve_label;
   ofxPanel gui_panel;
 
   // camera
   ofEasyCam cam;
 
+  // static graph layer, built once in world coordinates
+  // and split into a uniform grid of tiles, only the visible ones are drawn
+  struct Graph_tile {
+    ofRectangle bounds{};
+    ofVboMesh edges_mesh{};
+    // a circle instanced per vertex, only on the GPU;
+    // vertices smaller than a pixel are drawn as its centers
+    ofVbo vertices_vbo{};
+    // in the order of the instances
+    Vector<ofColor> goal_colors{};
+    Vector<int> vertex_ids{};
+    // glyphs of all the vertex ids, textured by the font atlas,
+    // built when first drawn
+    ofVboMesh labels_mesh{};
+  };
+  Vector<Graph_tile> graph_tiles{};
+
+  // world coordinates seen by the camera in the current frame
+  ofRectangle visible_rect{};
+  float pixels_per_unit{1};
+
+  // instanced circles of the agents and of the vertices
+  ofShader circles_shader;
+  bool shaded_circles{};
+  // instanced agents, all drawn in a single call
+  ofVbo agents_vbo;
+  // per agent: x, y, radius
+  Vector<glm::vec3> agents_instances{};
+  Vector<ofFloatColor> agents_colors{};
+  // only of the visible agents
+  Vector<ofFloatColor> agents_instance_colors{};
+
+  // glyphs of the agent ids relative to the agent,
+  // moved and merged into a single mesh every frame
+  Vector<ofMesh> agents_label_meshes{};
+  ofVboMesh agents_labels_mesh{};
+
+  // trajectories of all agents as line segments, built once per timeline;
+  // only the remaining segments are drawn, from the current action of each agent
+  struct Paths {
+    ofVbo vbo;
+    // of each agent, and the end of the buffer
+    Vector<GLint> first{};
+    bool dirty{true};
+  };
+  // of each agent in the buffer, while the plan is live
+  static constexpr int paths_min_spare_segments = 8;
+  // per playback
+  Vector<Paths> paths{};
+  Vector<GLint> paths_draw_first{};
+  Vector<GLsizei> paths_draw_count{};
+  // from the agents to their next waypoints or goals
+  ofVboMesh paths_heads_mesh{};
+
+  // with more playbacks, the graph is rendered once per frame
+  // and the layers are then drawn into each viewport
+  ofFbo edges_fbo;
+  ofFbo vertices_fbo;
+
+  // occupancy accumulated by the playback steps, in plan coordinates
+  Heatmap heatmap{};
+  // colored on the CPU only without the shader
+  ofPixels heatmap_pixels{};
+  ofTexture heatmap_texture{};
+  ofShader heatmap_shader;
+  bool shaded_heatmap{};
+  bool heatmap_dirty{};
+  bool instanced_agents{};
+
   // record
   ofxGifEncoder gif_encoder;
   ofFbo record_fbo;
-  ofPixels record_pixels;
+  // frames are read back asynchronously into a ring of pixel buffers,
+  // a frame is encoded only while the next two render
+  static constexpr int record_buffers = 3;
+  array<ofBufferObject, record_buffers> record_pbos{};
+  size_t record_n_read{};
+  size_t record_n_added{};
+  // of the rendered chunk, negative if it lasts until the end
+  long render_frames_left{-1};
+  // chosen when the recording starts, videos are encoded on the fly
+  string record_fn{};
+  Video_pipe video_pipe{};
+  // being saved in the background
+  string gif_fn{};
+  // shared with `main`, which outlives the app, to exit with a failure
+  shared_ptr<bool> record_failed_l{make_shared<bool>(false)};
 
   ofApp(const Graph*, graph::Properties, agent::plan::Global, agent::plan::Global_states);
   ofApp(const Graph&, agent::plan::Global, agent::plan::Global_states);
@@ -76,8 +219,16 @@ struct ofApp : ofBaseApp {
   ofApp(const Graph*, graph::Properties, agent::plan::Global_states);
   ofApp(const Graph&, agent::plan::Global_states);
   ofApp(agent::plan::Global_states);
+  ofApp(const Graph&, Timeline);
+  ofApp(const Graph*, graph::Properties, Timeline);
+  ofApp(const Graph&, unique_ptr<Timeline_stream>);
 
   void init();
+  void initPlaybacks();
+  void setPlan(agent::plan::Global);
+  void comparePlan(const agent::plan::Global&, string name);
+  const agent::plan::Global_states& statesPlan();
+  void dumpPlan();
 
   template <typename  T>
   T scaled(const T&) const;
@@ -86,25 +237,80 @@ struct ofApp : ofBaseApp {
   Coord adjusted_pos(Coord) const;
   template <typename  T>
   Coord adjusted_pos_of(const T&) const;
+  Coord adjusted_pos_of_agent(const Playback&, const agent::Id&) const;
+  ofRectangle viewport(int idx) const;
 
+  bool headless() const;
   bool recording() const;
-  bool screenshot_or_recording() const;
 
-  enum class StepMode { def = 0, partial, manual };
+  enum class StepMode { def = 0, manual };
 
   void setup() override;
+  void setupHeadless();
+  void setupHeadlessChunk();
   void reset();
+  void setTime(float t);
+  void seek(float t);
+  void loadStreamWindow(float t_begin, float t_end);
   template <StepMode = {}>
   void doStep(float step);
   template <StepMode = {}>
-  void doStepImpl(float step, float t, float t_next);
+  void doStepImpl(float t, float t_next);
   void doStepAdvanceAgs(float step);
   void doStepSwitch(float step);
+  void updateSwitchTimeThreshold();
   void update() override;
+  void updatePendingPlan();
+  void updatePlanSocket();
+  void watchFiles();
+  void updateFileWatch();
+  void reloadPlan(bool layout_changed);
+  void reloadTimeline(Timeline);
+  void updateHeadless();
+  void updateCollisions();
+
+  void updateView(const ofRectangle& viewport);
+  bool visible(const ofRectangle&) const;
+  bool visible(float x, float y, float r) const;
+  void zoom(float factor);
+
+  void buildGraphLayer();
+  void updateGraphLayerColors();
+  void drawEdges();
+  void drawVertices();
+  void setupCirclesShader();
+  void setupAgentsInstancing();
+  void buildAgentsLabels();
+  void drawAgents(const Playback&);
+  bool drawingLabels() const;
+  void buildLabelsMesh(Graph_tile&);
+  void drawLabelsMesh(ofVboMesh&);
+  void drawAgentsLabels(const Playback&);
+  void drawCollisions(const Playback&);
+  void drawProfiler();
+  void setupHeatmap();
+  void setupHeatmapShader();
+  void computeHeatmap();
+  void drawHeatmap();
+  void buildPaths(int idx);
+  void appendPath(int idx, Idx aid);
+  void drawPaths(int idx);
+  void setupGraphLayers();
+  void renderGraphLayers();
+  void drawGraphLayer(const ofFbo&, const ofRectangle& viewport);
+  void drawPlayback(int idx);
   void draw() override;
 
+  Vector_image makeVectorImage() const;
+  void saveVectorImage(const string& fn) const;
+
   void onFinish();
+  string recordFileName() const;
   void saveRecord();
+  void dropRecord();
+  void readRecordFrame();
+  void addRecordFrame();
+  void flushRecordFrames();
 
   void keyPressed(int key) override;
   void keyReleased(int key) override;
@@ -118,6 +324,7 @@ struct ofApp : ofBaseApp {
   void dragEvent(ofDragInfo dragInfo) override;
   void gotMessage(ofMessage msg) override;
 
+  void onTimestepChanged(float& t);
   void onGifSaved(string& fileName);
 
   void exit() override;
@@ -8,6 +8,18 @@ static constexpr int screen_y_buffer = 75;
 static constexpr int window_x_buffer = 25;
 static constexpr int window_y_top_buffer = 50;
 static constexpr int window_y_bottom_buffer = 25;
+static constexpr int vertex_circle_resolution = 16;
+static constexpr int agent_circle_resolution = 32;
+// approx. number of vertices per tile of the graph layer
+static constexpr int graph_tile_vertices = 4096;
+// level of detail in pixels on the screen
+static constexpr float vertex_point_radius_px = 1;
+static constexpr float vertex_skip_radius_px = 0.25;
+static constexpr float label_min_size_px = 4;
+static constexpr float zoom_factor = 1.25;
+// along the longer side of the map
+static constexpr int heatmap_max_cells = 512;
+static constexpr float heatmap_step = 0.05;
 
 // color scheme
 namespace Color
@@ -17,6 +29,7 @@ namespace Color
   static const ofColor font = ofColor(100, 100, 100);
   static const ofColor font_info = ofColor(0, 0, 0);
   static const ofColor edge = ofColor(100, 100, 100);
+  static const ofColor collision = ofColor(255, 0, 0);
   static const std::vector<ofColor> agents = {
       ofColor(233, 30, 99),  ofColor(33, 150, 243), ofColor(76, 175, 80),
       ofColor(255, 152, 0),  ofColor(0, 188, 212),  ofColor(156, 39, 176),
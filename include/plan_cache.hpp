@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "mapf_r/agent/plan.hpp"
+
+using namespace mapf_r;
+
+// On-disk cache of solved plans, addressed by the contents of the inputs:
+// the key is a hash of the graph and layout files and of the solver identity,
+// so renamed or copied instances still hit and edited ones do not.
+// Entries are plain-text plans, the same as the `<plan>` argument.
+namespace plan_cache {
+  // bump when the solver or its encoding changes the resulting plans
+  inline constexpr const char* solver_id = "mathsat/1";
+
+  using Key = uint64_t;
+
+  // `$XDG_CACHE_HOME/mapf_r-visualizer`, or `~/.cache/mapf_r-visualizer`
+  std::string dir();
+
+  Key make_key(const std::string& graph_path, const std::string& layout_path);
+  std::string path_of(Key);
+
+  std::optional<agent::plan::Global> load(Key);
+  // failures are not fatal, the cache is only an optimization
+  void save(Key, const agent::plan::Global&);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "timeline.hpp"
+
+// Live plan appended by another process, such as an online planner,
+// over a Unix domain socket: each line `<agent> <t> <x> <y>` appends
+// a waypoint to the track of the agent, in the order of time.
+// Clients connect one after another, reading never blocks.
+struct Plan_socket {
+  struct Append {
+    std::size_t aid;
+    Timeline::Waypoint waypoint;
+  };
+
+  Plan_socket() = default;
+  ~Plan_socket();
+  Plan_socket(const Plan_socket&) = delete;
+  Plan_socket& operator=(const Plan_socket&) = delete;
+
+  bool is_open() const { return listen_fd >= 0; }
+
+  // replaces a stale socket file, but no other file
+  void open(const std::string& path);
+  void close();
+
+  // of the complete lines received so far, malformed lines are skipped
+  void poll(std::vector<Append>&);
+  static bool parse(const std::string& line, Append&);
+
+  std::string path{};
+  int listen_fd{-1};
+  int client_fd{-1};
+  // incomplete line
+  std::string buffer{};
+};
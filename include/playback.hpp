@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "timeline.hpp"
+#include "motion.hpp"
+#include "collisions.hpp"
+
+// Playback of a single plan: the actions of its agents in progress at the current time.
+// The agents switch to their next actions in the order of the end times of the actions,
+// so a step costs only the agents that switch, the others just advance.
+// Several plans of the same agents share the clock, each with its own playback.
+struct Playback {
+  using Idx = std::size_t;
+
+  static constexpr float t_inf = Timeline::t_inf;
+
+  // shown when comparing more plans
+  std::string name{};
+
+  Timeline timeline{};
+  // of all the compared plans, beyond its own
+  float makespan{};
+
+  std::vector<Idx> action_idx{};
+  // min-heap of the end times of the agents' current actions
+  std::vector<std::pair<float, Idx>> switch_events{};
+  float switch_time_threshold{t_inf};
+  // positions of the agents
+  Motion motion{};
+  // of the current positions
+  Collisions collisions{};
+
+  Idx size() const { return timeline.size(); }
+  bool empty() const { return timeline.empty(); }
+
+  // after the timeline has changed
+  void init();
+
+  void seek(float t);
+  // to the track of the agent at time `t`, which otherwise continues as it was;
+  // an agent that was staying at its last waypoint moves on
+  void append(Idx aid, Timeline::Waypoint, float t);
+  void advance(float step) { motion.advance(step); }
+  // of the agents whose actions end at `switch_time_threshold`,
+  // returns their number
+  Idx switch_actions();
+  void update_switch_time_threshold();
+
+  void detect_collisions();
+};
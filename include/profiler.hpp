@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Durations of the phases of frames, with rolling statistics
+// over the last frames and an optional per-frame CSV trace.
+// When disabled, the scopes do not even read the clock.
+struct Profiler {
+  using Clock = std::chrono::steady_clock;
+
+  enum class Phase { advance, switch_, edges, vertices, agents, labels, readback, encode, n_phases };
+  static constexpr std::size_t n_phases = std::size_t(Phase::n_phases);
+  static constexpr std::array<const char*, n_phases> phase_names = {
+    "advance", "switch", "edges", "vertices", "agents", "labels", "readback", "encode"
+  };
+  static constexpr std::size_t window = 240;
+
+  struct Scope {
+    Scope(Profiler* p, Phase ph) : profiler_l(p), phase(ph) { if (profiler_l) start = Clock::now(); }
+    ~Scope() { if (profiler_l) profiler_l->add(phase, Clock::now() - start); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    Profiler* profiler_l;
+    Phase phase;
+    Clock::time_point start{};
+  };
+
+  struct Stats { float p50, p99; };
+
+  bool enabled{};
+
+  Scope scope(Phase ph) { return {enabled ? this : nullptr, ph}; }
+
+  void enable(bool);
+  void open_trace(const std::string& path);
+
+  void add(Phase, Clock::duration);
+  void add_switches(std::size_t n) { if (enabled) curr_switches += n; }
+
+  void end_frame(float time);
+
+  // in milliseconds, over the window
+  Stats stats(Phase) const;
+  Stats switches_stats() const;
+
+  // the current frame
+  std::array<double, n_phases> curr_ms{};
+  std::size_t curr_switches{};
+
+  // ring buffers over the last `window` frames
+  std::array<std::vector<float>, n_phases> history_ms{};
+  std::vector<float> history_switches{};
+  std::size_t n_frames{};
+
+  std::ofstream trace{};
+};
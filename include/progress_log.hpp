@@ -0,0 +1,27 @@
+#pragma once
+
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// Output stream forwarded to another one,
+// with the last complete line also readable from other threads
+struct Progress_log : std::ostream {
+  struct Buf : std::streambuf {
+    explicit Buf(std::ostream& forward_) : forward(forward_) { }
+
+    int overflow(int c) override;
+
+    std::ostream& forward;
+    std::string line{};
+    std::string last_line{};
+    mutable std::mutex mtx{};
+  };
+
+  explicit Progress_log(std::ostream& forward);
+
+  std::string last_line() const;
+
+  Buf buf;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Offline rendering split into time chunks rendered by parallel processes,
+// each with its own GL context and playback state seeked to its chunk.
+// The video segments are then joined in order without re-encoding.
+namespace render_jobs {
+  // video containers whose segments can be concatenated by stream copy
+  bool supports(const std::string& output);
+
+  std::string part_path(const std::string& output, int chunk);
+
+  // runs the program `args` once per chunk with the chunk options appended,
+  // returns the exit code
+  int run(const std::vector<std::string>& args, const std::string& output, int n_jobs);
+}
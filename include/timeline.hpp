@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Plan of all agents flattened into a time index:
+// each agent moves linearly between its consecutive waypoints
+// and stays at the last one forever.
+// The i-th waypoint starts the i-th action (state) of the agent.
+struct Timeline {
+  struct Waypoint {
+    float t;
+    float x, y;
+
+    bool operator==(const Waypoint&) const = default;
+  };
+
+  using Idx = std::size_t;
+  using Track = std::span<const Waypoint>;
+
+  static constexpr float t_inf = std::numeric_limits<float>::infinity();
+
+  std::vector<Track> tracks{};
+  std::vector<float> radii{};
+  std::vector<float> abs_vs{};
+
+  // tracks may also view external memory, which is then kept alive here
+  std::vector<std::vector<Waypoint>> storage{};
+  std::shared_ptr<const void> external_storage{};
+
+  float makespan{};
+
+  Timeline() = default;
+  // the stored tracks of a copy view its own storage
+  Timeline(const Timeline&);
+  Timeline& operator=(const Timeline&);
+  Timeline(Timeline&&) = default;
+  Timeline& operator=(Timeline&&) = default;
+
+  Idx size() const { return tracks.size(); }
+  bool empty() const { return tracks.empty(); }
+
+  const Track& ctrack(Idx aid) const { return tracks[aid]; }
+
+  void clear();
+  void add_track(std::vector<Waypoint>, float radius, float abs_v);
+  void add_track_view(Track, float radius, float abs_v);
+  // to the end of the track, which must be stored here,
+  // the previous waypoints are not touched (up to reallocation of the storage)
+  void append(Idx aid, Waypoint);
+  // whether all the tracks are stored here
+  bool owned() const { return storage.size() == size(); }
+
+  // index of the action that is in progress at time `t`,
+  // i.e. of the last waypoint that is not after `t`;
+  // O(log n) in the number of waypoints
+  Idx find(Idx aid, float t) const;
+  // time when the action `idx` ends, infinite after the last waypoint
+  float end_time(Idx aid, Idx idx) const;
+};
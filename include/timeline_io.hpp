@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "mapf_r/agent/plan.hpp"
+
+#include "timeline.hpp"
+
+using namespace mapf_r;
+
+Timeline make_timeline(const agent::plan::Global_states&);
+
+// Binary plan format `.spb` of fixed-size records in native byte order:
+// header, table of agents and waypoints of all agents one after another.
+// Loading maps the file into memory, the tracks view the mapping directly.
+namespace spb {
+  inline constexpr char magic[4] = {'S', 'P', 'B', '\0'};
+  inline constexpr uint32_t version = 1;
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t n_agents;
+    uint64_t n_waypoints;
+    float makespan;
+    uint32_t reserved;
+  };
+
+  struct Agent_record {
+    uint64_t begin;
+    uint64_t size;
+    float radius;
+    float abs_v;
+  };
+
+  static_assert(sizeof(Header) == 32);
+  static_assert(sizeof(Agent_record) == 24);
+  static_assert(sizeof(Timeline::Waypoint) == 12);
+
+  std::size_t agents_offset();
+  std::size_t waypoints_offset(const Header&);
+  // expects a valid header of a file of the given size
+  void check(const Header&, std::size_t file_size, const std::string& path);
+  void check(const Agent_record&, const Header&, const std::string& path);
+
+  Timeline load(const std::string& path);
+  void save(const Timeline&, const std::string& path);
+}  // namespace spb
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "timeline_io.hpp"
+
+// Sliding time window over a binary plan `.spb` that does not have to fit in memory.
+// Only the waypoints of the actions that overlap the window are loaded,
+// the next window is prefetched on a background thread.
+struct Timeline_stream {
+  using Idx = Timeline::Idx;
+
+  struct Window {
+    Timeline timeline{};
+    float begin{};
+    // infinite if the window reaches the end of the plan
+    float end{};
+
+    bool covers(float t_begin, float t_end) const { return begin <= t_begin && t_end < end; }
+  };
+
+  Timeline_stream(const std::string& path, float window_duration);
+  ~Timeline_stream();
+
+  Idx size() const { return records.size(); }
+  float makespan() const { return header.makespan; }
+
+  Timeline::Waypoint read_waypoint(Idx aid, Idx i) const;
+
+  // at least [t_begin, t_end)
+  Window load(float t_begin, float t_end) const;
+  void prefetch(float t_begin, float t_end);
+  // the prefetched window if it covers the range, otherwise loads it right away;
+  // then starts prefetching the following window
+  Window take(float t_begin, float t_end);
+
+  std::string path;
+  int fd{-1};
+  spb::Header header{};
+  std::vector<spb::Agent_record> records{};
+  float window_duration;
+
+  std::future<Window> prefetched{};
+};
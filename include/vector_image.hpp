@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Vector image of a single frame, with the primitives merged by color:
+// each layer is written as one stroked path of lines and one filled path of discs,
+// so the number of operations does not grow with the number of the primitives
+// and the files stay small even for large graphs.
+struct Vector_image {
+  struct Rgb {
+    uint8_t r, g, b;
+    bool operator==(const Rgb&) const = default;
+  };
+  struct Line { float x0, y0, x1, y1; };
+  struct Disc { float x, y, r; };
+  struct Text { float x, y; std::string str; };
+
+  struct Layer {
+    // consecutive layers with the same group are written as one group
+    std::string group;
+    Rgb color;
+    float line_width{1};
+    float font_size{12};
+    std::vector<Line> lines{};
+    std::vector<Disc> discs{};
+    std::vector<Text> texts{};
+  };
+
+  float width{}, height{};
+  Rgb bg{255, 255, 255};
+  // in the order of drawing
+  std::vector<Layer> layers{};
+
+  // the last layer of `group` with `color`, if it is not interleaved by others
+  Layer& layer(const std::string& group, Rgb color);
+
+  // by the extension, `.svg` or `.pdf`
+  void save(const std::string& path) const;
+  void save_svg(const std::string& path) const;
+  void save_pdf(const std::string& path) const;
+};
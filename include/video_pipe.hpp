@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+// Raw RGB frames streamed into a child `ffmpeg` process through a pipe,
+// so that encoding overlaps with rendering and no frames are kept in memory.
+// The container and codec follow from the extension of the output file.
+struct Video_pipe {
+  Video_pipe() = default;
+  ~Video_pipe();
+  Video_pipe(const Video_pipe&) = delete;
+  Video_pipe& operator=(const Video_pipe&) = delete;
+
+  // `.mp4`, `.webm`, `.mkv` or `.apng`
+  static bool supports(const std::string& path);
+  static std::vector<std::string> encoder_args(const std::string& path);
+
+  bool is_open() const { return fd >= 0; }
+
+  void open(const std::string& path, int width, int height, float fps);
+  // blocks only while ffmpeg is behind by more than the pipe buffer
+  bool write(const unsigned char* rgb);
+  // waits until the file is finalized, returns whether it succeeded
+  bool close();
+
+  std::string path{};
+  std::size_t frame_size{};
+  int fd{-1};
+  pid_t pid{-1};
+};
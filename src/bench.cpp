@@ -0,0 +1,171 @@
+#include "../include/bench.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+#include "../include/ofApp.hpp"
+#include "../include/timeline_io.hpp"
+
+#include <tomaqa.hpp>
+
+namespace bench {
+  using Clock = std::chrono::steady_clock;
+
+  // 4-connected grid of unit cells, written as a `.g` file:
+  // the number of vertices, the coordinates of each, then the edges by the ids of their vertices
+  static std::string make_grid_graph_text(int side)
+  {
+    std::ostringstream oss;
+    const long n_vertices = long(side)*side;
+    oss << n_vertices << '\n';
+    for (long vid = 0; vid < n_vertices; ++vid) oss << vid % side << ' ' << vid / side << '\n';
+
+    const long n_edges = 2L*side*(side-1);
+    oss << n_edges << '\n';
+    for (long vid = 0; vid < n_vertices; ++vid) {
+      if (vid % side + 1 < side) oss << vid << ' ' << vid+1 << '\n';
+      if (vid / side + 1 < side) oss << vid << ' ' << vid+side << '\n';
+    }
+    return oss.str();
+  }
+
+  // random walks on the grid with random waits, written as a `.stp` file:
+  // each agent by its id, radius, speed and number of states,
+  // then each state by its start and end positions and its duration;
+  // the agents start at distinct cells of a grid 4 times larger
+  static std::string make_grid_plan_text(long n_agents, long n_actions, int side, std::mt19937& gen)
+  {
+    std::vector<int> cells(long(side)*side);
+    std::iota(cells.begin(), cells.end(), 0);
+    std::shuffle(cells.begin(), cells.end(), gen);
+
+    std::uniform_int_distribution<int> action_dist(0, 4);
+    std::uniform_real_distribution<float> wait_dist(0.5, 2);
+
+    std::ostringstream oss;
+    oss << n_agents << '\n';
+    for (long aid = 0; aid < n_agents; ++aid) {
+      int x = cells[aid] % side, y = cells[aid] / side;
+      oss << aid << ' ' << 0.3 << ' ' << 1 << ' ' << n_actions << '\n';
+      for (long i = 0; i < n_actions; ++i) {
+        int nx = x, ny = y;
+        switch (action_dist(gen)) {
+        case 0: ++nx; break;
+        case 1: --nx; break;
+        case 2: ++ny; break;
+        case 3: --ny; break;
+        }
+        const bool moves = (nx != x || ny != y) && nx >= 0 && nx < side && ny >= 0 && ny < side;
+        if (!moves) {
+          nx = x;
+          ny = y;
+        }
+        const float duration = moves ? 1 : wait_dist(gen);
+        oss << x << ' ' << y << ' ' << nx << ' ' << ny << ' ' << duration << '\n';
+        x = nx;
+        y = ny;
+      }
+    }
+    return oss.str();
+  }
+
+  template <typename F>
+  static double measure(F f, long n_iters = 1)
+  {
+    const auto start = Clock::now();
+    for (long i = 0; i < n_iters; ++i) f();
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    return elapsed.count()/n_iters;
+  }
+
+  int run(const std::string& output, bool with_draw)
+  {
+    using namespace tomaqa;
+    using namespace std;
+
+    ofstream ofs(output);
+    expect(ofs, "Benchmark results not writable: "s + output);
+    ofs << "benchmark,n_agents,n_waypoints,n_iterations,seconds_per_iteration" << endl;
+
+    const string spb_path = output + ".spb";
+    for (long n_agents : {100L, 1'000L, 10'000L, 100'000L}) {
+      // roughly the same total number of waypoints for the larger sizes
+      const long n_actions = clamp(2'000'000L/n_agents, 20L, 1'000L);
+      const int side = ceil(sqrt(4.*n_agents));
+      mt19937 gen(n_agents);
+
+      const auto report = [&](const string& name, long n_iters, double seconds){
+        ofs << name << ',' << n_agents << ',' << n_agents*(n_actions+1) << ','
+            << n_iters << ',' << seconds << endl;
+        cout << name << " [" << n_agents << " agents]: " << seconds*1e3 << " ms" << endl;
+      };
+
+      // parsed by mapf_r the same as the files given on the command line
+      const string graph_text = make_grid_graph_text(side);
+      const string plan_text = make_grid_plan_text(n_agents, n_actions, side, gen);
+      Graph g;
+      report("graph_load", 1, measure([&]{
+        istringstream iss(graph_text);
+        g = {iss};
+      }));
+      agent::plan::Global_states splan;
+      report("plan_load", 1, measure([&]{
+        istringstream iss(plan_text);
+        splan = agent::plan::Global_states(iss);
+      }));
+
+      // including the conversion of the states into the timeline
+      unique_ptr<ofApp> app_l;
+      report("app_init", 1, measure([&]{ app_l = make_unique<ofApp>(g, move(splan)); }));
+      auto& app = *app_l;
+
+      Timeline timeline;
+      report("spb_save", 1, measure([&]{ spb::save(app.playback().timeline, spb_path); }));
+      report("spb_load", 1, measure([&]{ timeline = spb::load(spb_path); }));
+      timeline.clear();
+
+      // across all the switches of the actions
+      constexpr float step = 0.05;
+      long n_steps = 0;
+      const double step_total = measure([&]{
+        while (!app.finished) {
+          app.doStep(step);
+          ++n_steps;
+        }
+      });
+      report("step", n_steps, step_total/max(n_steps, 1L));
+
+      constexpr long n_seeks = 100;
+      uniform_real_distribution<float> time_dist(0, app.makespan);
+      report("seek", n_seeks, measure([&]{ app.seek(time_dist(gen)); }, n_seeks));
+
+      if (!with_draw) continue;
+
+      app.setup();
+      // the edges and vertices are drawn with the graph, the labels once readable
+      app.flg_font = true;
+      app.seek(0);
+      constexpr long n_frames = 100;
+      auto& renderer = *ofGetCurrentRenderer();
+      report("frame", n_frames, measure([&]{
+        app.doStep(step);
+        renderer.startRender();
+        app.draw();
+        renderer.finishRender();
+        // also the work queued on the GPU
+        glFinish();
+      }, n_frames));
+    }
+
+    std::error_code ec;
+    filesystem::remove(spb_path, ec);
+    cout << "results written to " << output << endl;
+    return 0;
+  }
+}
@@ -0,0 +1,65 @@
+#include "../include/collisions.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+static uint32_t hash(Collisions::Cell c, uint32_t mask)
+{
+  return (uint32_t(c.x)*73856093u ^ uint32_t(c.y)*19349663u) & mask;
+}
+
+void Collisions::detect(std::span<const float> x, std::span<const float> y, std::span<const float> radii)
+{
+  const Idx n = x.size();
+  assert(y.size() == n);
+  assert(radii.size() == n);
+
+  pairs.clear();
+  colliding.assign(n, false);
+  if (n < 2) return;
+
+  const float max_r = *std::max_element(radii.begin(), radii.end());
+  if (!(max_r > 0)) return;
+  const float cell_size = 2*max_r;
+
+  // counting sort of the agents into the buckets
+  const uint32_t n_buckets = std::bit_ceil(uint32_t(n));
+  const uint32_t mask = n_buckets - 1;
+  cells.resize(n);
+  bucket_begin.assign(n_buckets+1, 0);
+  bucket_items.resize(n);
+  for (Idx i = 0; i < n; ++i) {
+    cells[i] = {int32_t(std::floor(x[i]/cell_size)), int32_t(std::floor(y[i]/cell_size))};
+    ++bucket_begin[hash(cells[i], mask)+1];
+  }
+  for (uint32_t b = 0; b < n_buckets; ++b) bucket_begin[b+1] += bucket_begin[b];
+  {
+    auto next = bucket_begin;
+    for (Idx i = 0; i < n; ++i) bucket_items[next[hash(cells[i], mask)]++] = i;
+  }
+
+  for (Idx i = 0; i < n; ++i) {
+    const Cell c = cells[i];
+    for (int dy = -1; dy <= 1; ++dy) for (int dx = -1; dx <= 1; ++dx) {
+      const Cell nc{c.x + dx, c.y + dy};
+      const uint32_t b = hash(nc, mask);
+      for (uint32_t k = bucket_begin[b]; k < bucket_begin[b+1]; ++k) {
+        const Idx j = bucket_items[k];
+        // other cells may share the bucket, each pair is tested once
+        if (j <= i || cells[j] != nc) continue;
+
+        const float ddx = x[j] - x[i];
+        const float ddy = y[j] - y[i];
+        const float r = (radii[i] + radii[j])*(1 - tolerance);
+        if (ddx*ddx + ddy*ddy >= r*r) continue;
+
+        pairs.emplace_back(i, j);
+        colliding[i] = colliding[j] = true;
+      }
+    }
+  }
+
+  std::sort(pairs.begin(), pairs.end());
+}
@@ -0,0 +1,80 @@
+#include "../include/file_watch.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <tomaqa.hpp>
+
+File_watch::~File_watch()
+{
+  if (is_open()) close();
+}
+
+void File_watch::open()
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  assert(!is_open());
+  fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  expect(fd >= 0, "Cannot watch files: "s + strerror(errno));
+}
+
+void File_watch::close()
+{
+  assert(is_open());
+  ::close(fd);
+  fd = -1;
+  files.clear();
+}
+
+std::size_t File_watch::add(const std::string& path)
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  assert(is_open());
+  const auto abs_path = filesystem::absolute(path);
+  const string dir = abs_path.parent_path().string();
+  // the same directory gets the same descriptor
+  const int wd = ::inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+  expect(wd >= 0, "Cannot watch directory "s + dir + ": " + strerror(errno));
+
+  files.push_back({wd, abs_path.filename().string()});
+  return files.size()-1;
+}
+
+std::vector<std::size_t> File_watch::poll()
+{
+  assert(is_open());
+
+  std::vector<std::size_t> changed;
+  alignas(inotify_event) char buf[1 << 14];
+  while (true) {
+    const ssize_t n = ::read(fd, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+
+    for (ssize_t off = 0; off < n;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(buf + off);
+      off += sizeof(inotify_event) + event->len;
+      if (event->len == 0) continue;
+
+      for (std::size_t i = 0; i < files.size(); ++i) {
+        auto& file = files[i];
+        if (file.wd == event->wd && file.name == event->name) changed.push_back(i);
+      }
+    }
+  }
+
+  // a file is often written more times in a row
+  std::ranges::sort(changed);
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  return changed;
+}
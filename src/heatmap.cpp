@@ -0,0 +1,92 @@
+#include "../include/heatmap.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+void Heatmap::setup(float min_x_, float min_y_, float max_x, float max_y, int max_cells)
+{
+  assert(max_x >= min_x_ && max_y >= min_y_);
+  assert(max_cells > 0);
+
+  min_x = min_x_;
+  min_y = min_y_;
+  cell_size = std::max(std::max(max_x - min_x, max_y - min_y)/max_cells, 1e-3f);
+  width = std::max(1, int(std::ceil((max_x - min_x)/cell_size)));
+  height = std::max(1, int(std::ceil((max_y - min_y)/cell_size)));
+  heat.assign(size_t(width)*height, 0);
+  max_heat = 0;
+}
+
+void Heatmap::clear()
+{
+  std::fill(heat.begin(), heat.end(), 0);
+  max_heat = 0;
+}
+
+void Heatmap::add(float x, float y, float radius, float dt)
+{
+  const float cx = (x - min_x)/cell_size;
+  const float cy = (y - min_y)/cell_size;
+  const float cr = radius/cell_size;
+  const int x0 = std::max(0, int(std::ceil(cx - cr - 0.5f)));
+  const int x1 = std::min(width-1, int(std::floor(cx + cr - 0.5f)));
+  const int y0 = std::max(0, int(std::ceil(cy - cr - 0.5f)));
+  const int y1 = std::min(height-1, int(std::floor(cy + cr - 0.5f)));
+
+  bool covered = false;
+  for (int j = y0; j <= y1; ++j) {
+    const float dy = j + 0.5f - cy;
+    for (int i = x0; i <= x1; ++i) {
+      const float dx = i + 0.5f - cx;
+      if (dx*dx + dy*dy > cr*cr) continue;
+      float& h = heat[size_t(j)*width + i];
+      h += dt;
+      max_heat = std::max(max_heat, h);
+      covered = true;
+    }
+  }
+  if (covered) return;
+
+  // smaller than a cell, it still counts
+  const int i = int(std::floor(cx)), j = int(std::floor(cy));
+  if (i < 0 || i >= width || j < 0 || j >= height) return;
+  float& h = heat[size_t(j)*width + i];
+  h += dt;
+  max_heat = std::max(max_heat, h);
+}
+
+void Heatmap::add(std::span<const float> x, std::span<const float> y,
+                  std::span<const float> radii, float dt)
+{
+  assert(x.size() == y.size());
+  assert(x.size() == radii.size());
+  const size_t n = x.size();
+  for (size_t i = 0; i < n; ++i) add(x[i], y[i], radii[i], dt);
+}
+
+// the waypoints of each agent are walked once, in order
+void Heatmap::add(const Timeline& timeline, float step)
+{
+  assert(step > 0);
+  const float end = timeline.makespan;
+  const size_t n_agents = timeline.size();
+  for (size_t aid = 0; aid < n_agents; ++aid) {
+    auto& track = timeline.ctrack(aid);
+    if (track.empty()) continue;
+    const float r = timeline.radii[aid];
+
+    size_t idx = 0;
+    for (float t = step/2; t < end; t += step) {
+      while (idx+1 < track.size() && track[idx+1].t <= t) ++idx;
+      auto& from = track[idx];
+      if (idx+1 == track.size()) {
+        add(from.x, from.y, r, step);
+        continue;
+      }
+      auto& to = track[idx+1];
+      const float a = (t - from.t)/(to.t - from.t);
+      add(from.x + (to.x - from.x)*a, from.y + (to.y - from.y)*a, r, step);
+    }
+  }
+}
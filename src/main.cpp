@@ -1,25 +1,200 @@
+#include <atomic>
+#include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <thread>
 
 #include "../include/ofApp.hpp"
+#include "../include/timeline_io.hpp"
+#include "../include/plan_cache.hpp"
+#include "../include/render_jobs.hpp"
+#include "../include/bench.hpp"
 #include "ofMain.h"
+#include "ofAppGLFWWindow.h"
 
 #include "mapf_r/smt/solver/mathsat.hpp"
 
 #include <tomaqa.hpp>
 
-agent::plan::Global make_plan(bool solve, Graph& g, agent::Layout& layout)
+static ofApp::Render_config render_config{};
+static string convert_output{};
+static float stream_window{};
+static int render_n_jobs{1};
+static string export_output{};
+static float export_time{};
+static string bench_output{};
+static string trace_output{};
+static string plan_dump_output{};
+static string listen_path{};
+
+// strips the `--<option> <value>` pairs from the arguments
+static void parse_options(int& argc, char* argv[])
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  int n_args = 1;
+  for (int i = 1; i < argc; ++i) {
+    const string opt = argv[i];
+    if (!opt.starts_with("--")) {
+      argv[n_args++] = argv[i];
+      continue;
+    }
+
+    expect(i+1 < argc, "Missing value of option: "s + opt);
+    const string val = argv[++i];
+    if (opt == "--render") {
+      // relative paths would otherwise be resolved w.r.t. the data directory
+      render_config.output = filesystem::absolute(val).string();
+      expect(Path(val).extension() == ".gif" || Video_pipe::supports(val),
+             "Unsupported render format: "s + val);
+    }
+    else if (opt == "--fps") {
+      render_config.fps = stof(val);
+      expect(render_config.fps > 0, "Invalid FPS: "s + val);
+    }
+    else if (opt == "--speed") {
+      render_config.speed = stof(val);
+      expect(render_config.speed > 0, "Invalid speed: "s + val);
+    }
+    else if (opt == "--record-format") {
+      render_config.format = val;
+      expect(val == "gif" || Video_pipe::supports("." + val),
+             "Unsupported record format: "s + val);
+    }
+    else if (opt == "--jobs") {
+      render_n_jobs = stoi(val);
+      expect(render_n_jobs > 0, "Invalid number of jobs: "s + val);
+    }
+    else if (opt == "--chunk") {
+      // `<i>/<n>`, set by the parallel rendering itself
+      const auto sep = val.find('/');
+      expect(sep != string::npos, "Invalid chunk: "s + val);
+      render_config.chunk = stoi(val.substr(0, sep));
+      render_config.n_chunks = stoi(val.substr(sep+1));
+      expect(render_config.n_chunks > 0 && render_config.chunk >= 0
+             && render_config.chunk < render_config.n_chunks, "Invalid chunk: "s + val);
+    }
+    else if (opt == "--export") {
+      export_output = val;
+      const auto ext = Path(val).extension();
+      expect(ext == ".svg" || ext == ".pdf", "Unsupported image format: "s + val);
+    }
+    else if (opt == "--time") {
+      export_time = stof(val);
+      expect(export_time >= 0, "Invalid time: "s + val);
+    }
+    else if (opt == "--trace") {
+      trace_output = val;
+    }
+    else if (opt == "--listen") {
+      listen_path = filesystem::absolute(val).string();
+    }
+    else if (opt == "--dump-plan") {
+      plan_dump_output = val == "-" ? val : filesystem::absolute(val).string();
+    }
+    else if (opt == "--bench") {
+      bench_output = filesystem::absolute(val).string();
+    }
+    else if (opt == "--convert") {
+      convert_output = val;
+    }
+    else if (opt == "--stream") {
+      stream_window = stof(val);
+      expect(stream_window > 0, "Invalid stream window: "s + val);
+    }
+    else {
+      expect(false, "Unknown option: "s + opt);
+    }
+  }
+
+  argc = n_args;
+}
+
+static void setup_window()
+{
+  ofGLFWWindowSettings settings;
+  settings.setSize(100, 100);
+  settings.windowMode = OF_WINDOW;
+  // offline rendering only draws into an FBO
+  settings.visible = render_config.output.empty() && bench_output.empty();
+  ofCreateWindow(settings);
+}
+
+static bool exporting()
+{
+  return !export_output.empty();
+}
+
+static int run_app(ofApp* app_l)
+{
+  app_l->render_config = render_config;
+  if (!trace_output.empty()) app_l->profiler.open_trace(trace_output);
+  app_l->plan_dump_output = plan_dump_output;
+  app_l->dumpPlan();
+  if (!exporting()) {
+    // the app is gone once it has run
+    const auto record_failed_l = app_l->record_failed_l;
+    const int ret = ofRunApp(app_l);
+    return *record_failed_l ? 1 : ret;
+  }
+
+  // no window, the image is composed directly from the plan
+  unique_ptr<ofApp> app_ptr(app_l);
+  if (!app_ptr->playback().empty()) app_ptr->seek(export_time);
+  app_ptr->saveVectorImage(export_output);
+  return 0;
+}
+
+// reloaded on changes; relative to the working directory, not to the data directory
+static ofApp* watch_files(ofApp* app_l, const string& graph_fn, const string& plan_fn,
+                          const string& layout_fn = "")
+{
+  const auto abs = [](const string& fn){ return fn.empty() ? fn : filesystem::absolute(fn).string(); };
+  app_l->graph_fn = abs(graph_fn);
+  app_l->plan_fn = abs(plan_fn);
+  app_l->layout_fn = abs(layout_fn);
+  return app_l;
+}
+
+static bool listening()
+{
+  return !listen_path.empty();
+}
+
+static bool converting()
+{
+  return !convert_output.empty();
+}
+
+static int convert(const Timeline& timeline)
+{
+  spb::save(timeline, convert_output);
+  std::cout << "plan converted into " << convert_output << std::endl;
+  return 0;
+}
+
+agent::plan::Global make_plan(bool solve, Graph& g, agent::Layout& layout,
+                              plan_cache::Key key, ostream& os = cout)
 {
   using Solver = smt::solver::Mathsat;
 
   if (solve) {
+    if (auto cached = plan_cache::load(key)) {
+      os << "using cached plan " << plan_cache::path_of(key) << endl;
+      return move(*cached);
+    }
+
     Solver solver;
     solver.set_graph(g);
     solver.set_layout(layout);
 
-    solver.solve(cout);
+    solver.solve(os);
     if (solver.is_sat()) {
-      return solver.make_plan(cout);
+      auto plan = solver.make_plan(os);
+      plan_cache::save(key, plan);
+      return plan;
     }
   }
 
@@ -33,22 +208,60 @@ try {
 
   bool solve = true;
 
+  const vector<string> orig_args(argv, argv+argc);
+  parse_options(argc, argv);
+
   if (argc >= 2 && "0"s == argv[argc-1]) {
     solve = false;
     --argc;
   }
 
+  if (!bench_output.empty()) {
+    expect(argc == 1, "Benchmarks take no other arguments.");
+    setup_window();
+    return bench::run(bench_output, true);
+  }
+
   // simple arguments check
-  if (argc < 2 || argc > 4) {
-    cout << "Usage: bin/mapf_r-visualizer <graph> [<splan> | <layout> [<plan>]], e.g."
+  if (argc < 2) {
+    cout << "Usage: bin/mapf_r-visualizer [<options>] <graph> [<splan> | <layout> [<plan>...]], e.g."
          << "\nbin/mapf_r-visualizer data/graph/sample.g data/plan/sample.stp"
          << "\nbin/mapf_r-visualizer data/graph/sample.g data/layout/sample.l"
          << "\nbin/mapf_r-visualizer data/graph/sample.g data/layout/sample.l data/layout/sample.p"
+         << "\nbin/mapf_r-visualizer data/graph/sample.g data/layout/sample.l a.p b.p  (side by side)"
+         << "\nbin/mapf_r-visualizer data/graph/sample.g sample.spb"
+         << "\n\nOptions:"
+         << "\n--render <file> : render the whole plan offline into a GIF or video file and exit"
+         << "\n--fps <fps>     : frame rate of the rendered file [30]"
+         << "\n--speed <step>  : plan time step per rendered frame [0.05]"
+         << "\n--export <img>  : export the frame at `--time` into an SVG or PDF file and exit"
+         << "\n--time <t>      : plan time of the exported frame [0]"
+         << "\n--trace <csv>   : write the timings of the phases of each frame"
+         << "\n--listen <socket> : play a live plan appended by lines `<agent> <t> <x> <y>` on a Unix socket"
+         << "\n--dump-plan <file> : print the states plan into the file, `-` for the standard output"
+         << "\n--bench <csv>   : run the benchmarks on synthetic plans and exit"
+         << "\n--jobs <n>      : render in parallel by chunks of time into a video [1]"
+         << "\n--record-format <ext> : format of interactive recordings: gif, mp4, webm, mkv or apng [gif]"
+         << "\n--convert <spb> : convert the plan into the binary format and exit"
+         << "\n--stream <dt>   : stream a binary plan in time windows of the given duration"
          << endl;
     return 0;
   }
 
-  ofSetupOpenGL(100, 100, OF_WINDOW);
+  if (render_n_jobs > 1) {
+    expect(!render_config.output.empty(), "Parallel jobs require rendering.");
+    expect(render_jobs::supports(render_config.output),
+           "Parallel rendering requires an .mp4, .webm or .mkv output.");
+    expect(argc != 3 || !solve || contains({".stp", ".sp", ".spb"}, Path(argv[2]).extension()),
+           "Parallel rendering requires a plan, the jobs would solve it each.");
+    auto args = orig_args;
+    // the same program regardless of the working directory
+    args[0] = "/proc/self/exe";
+    return render_jobs::run(args, render_config.output, render_n_jobs);
+  }
+
+  expect(!exporting() || render_config.output.empty(), "Cannot both export and render.");
+  if (!converting() && !exporting()) setup_window();
 
   Path path = argv[1];
 
@@ -64,45 +277,121 @@ try {
   if (argc == 2) {
     // graph only
     if (!g.cvertices().empty()) {
-      ofRunApp(new ofApp(g));
-      return 0;
+      expect(render_config.output.empty(), "Rendering requires a plan.");
+      expect(!converting(), "Conversion requires a plan.");
+      return run_app(new ofApp(g));
     }
 
     // plan only
     ifstream p_ifs(path);
     expect(p_ifs, "Plan file not readable: "s + path.to_string());
     // only `Global_states`, `Global` requires graph
-    ofRunApp(new ofApp(agent::plan::Global_states(p_ifs)));
-    return 0;
+    agent::plan::Global_states stplan(p_ifs);
+    if (converting()) return convert(make_timeline(stplan));
+    return run_app(watch_files(new ofApp(move(stplan)), "", path.to_string()));
   }
 
   assert(!g.cvertices().empty());
   path = argv[2];
+  if (listening()) {
+    expect(argc == 3 && !contains({".stp", ".sp", ".spb"}, path.extension()),
+           "A live plan requires just a graph and a layout.");
+    expect(render_config.output.empty() && !exporting() && !converting(),
+           "A live plan cannot be rendered, exported or converted.");
+    // the agents wait at their starts
+    solve = false;
+  }
+
+  if (argc > 3) {
+    expect(!contains({".stp", ".sp", ".spb"}, path.extension()),
+           "Only plans of a layout can be compared: "s + path.to_string());
+  }
+
   if (contains({".stp", ".sp"}, path.extension())) {
     // load plan
     ifstream st_ifs(path);
     agent::plan::Global_states stplan(st_ifs);
-    ofRunApp(new ofApp(g, move(stplan)));
-    return 0;
+    if (converting()) return convert(make_timeline(stplan));
+    return run_app(watch_files(new ofApp(g, move(stplan)), argv[1], path.to_string()));
+  }
+
+  if (path.extension() == ".spb") {
+    expect(!converting(), "The plan is already binary.");
+    if (stream_window > 0) {
+      return run_app(new ofApp(g, make_unique<Timeline_stream>(path.to_string(), stream_window)));
+    }
+    return run_app(watch_files(new ofApp(g, spb::load(path.to_string())), argv[1], path.to_string()));
   }
 
   ifstream l_ifs(path);
   expect(l_ifs, "Layout file not readable: "s + path.to_string());
   agent::Layout layout(l_ifs);
+  const bool solving = argc == 3 && solve;
+  const auto cache_key = solving ? plan_cache::make_key(argv[1], path.to_string()) : plan_cache::Key{};
+
+  // the window opens with agents at their starts while solving,
+  // cached plans are loaded right away
+  if (solving && !filesystem::exists(plan_cache::path_of(cache_key))
+      && render_config.output.empty() && !converting() && !exporting()) {
+    auto log_l = make_shared<Progress_log>(cout);
+    auto done_l = make_shared<atomic<bool>>(false);
+    // the solver works on its own copies, the app reads `g` and `layout` meanwhile
+    auto solver_g_l = make_shared<Graph>(g);
+    auto solver_layout_l = make_shared<agent::Layout>(layout);
+    packaged_task<agent::plan::Global()> task([solver_g_l, solver_layout_l, cache_key, log_l, done_l]{
+      auto p = make_plan(true, *solver_g_l, *solver_layout_l, cache_key, *log_l);
+      *done_l = true;
+      return p;
+    });
+
+    auto app_l = new ofApp(g, layout, agent::plan::Global(layout));
+    app_l->pending_plan = task.get_future();
+    app_l->solve_log_l = log_l;
+    thread solver(move(task));
+
+    const int ret = run_app(app_l);
+    if (*done_l) {
+      solver.join();
+      return ret;
+    }
+    // the solver cannot be interrupted, it shares nothing with the rest
+    // but the log, so the process ends without waiting for it
+    solver.detach();
+    cout.flush();
+    _Exit(ret);
+  }
+
+  const auto read_plan = [](const Path& p_path) -> agent::plan::Global {
+    ifstream p_ifs(p_path);
+    expect(p_ifs, "Plan file not readable: "s + p_path.to_string());
+    return {p_ifs};
+  };
 
   agent::plan::Global plan;
-  if (argc == 4) {
-    path = argv[3];
-    ifstream p_ifs(path);
-    expect(p_ifs, "Plan file not readable: "s + path.to_string());
-    plan = {p_ifs};
+  if (argc >= 4) {
+    plan = read_plan(argv[3]);
   }
   else {
-    plan = make_plan(solve, g, layout);
+    plan = make_plan(solve, g, layout, cache_key);
   }
 
-  ofRunApp(new ofApp(g, layout, move(plan)));
-  return 0;
+  if (converting()) {
+    expect(argc <= 4, "Only a single plan can be converted.");
+    return convert(make_timeline(agent::plan::Global_states{plan, g, layout}));
+  }
+
+  auto app_l = new ofApp(g, layout, move(plan));
+  // the compared plans are not reloaded
+  if (argc == 4) watch_files(app_l, argv[1], argv[3], argv[2]);
+  if (listening()) {
+    app_l->plan_socket.open(listen_path);
+    cout << "listening on " << listen_path << endl;
+  }
+  // the graph is shared, each plan has its own playback
+  if (argc > 4) app_l->playback().name = argv[3];
+  for (int i = 4; i < argc; ++i) app_l->comparePlan(read_plan(argv[i]), argv[i]);
+
+  return run_app(app_l);
 }
 catch (const Error& err) {
   std::cerr << err << std::endl;
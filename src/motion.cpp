@@ -0,0 +1,64 @@
+#include "../include/motion.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+void Motion::resize(Idx n)
+{
+  for (auto* v : {&end_x, &end_y, &vel_x, &vel_y, &dt, &x, &y}) {
+    v->resize(n);
+  }
+}
+
+void Motion::set(Idx i, const Timeline::Track& track, Idx idx, float t)
+{
+  assert(i < size());
+  assert(idx < track.size());
+
+  auto& from = track[idx];
+  if (idx+1 == track.size()) {
+    // stays at the last waypoint
+    end_x[i] = x[i] = from.x;
+    end_y[i] = y[i] = from.y;
+    vel_x[i] = vel_y[i] = 0;
+    dt[i] = 0;
+    return;
+  }
+
+  auto& to = track[idx+1];
+  const float duration = to.t - from.t;
+  end_x[i] = to.x;
+  end_y[i] = to.y;
+  if (duration > 0) {
+    vel_x[i] = (to.x - from.x)/duration;
+    vel_y[i] = (to.y - from.y)/duration;
+  }
+  else {
+    vel_x[i] = vel_y[i] = 0;
+  }
+  dt[i] = std::clamp(to.t - t, 0.f, duration);
+  x[i] = to.x - vel_x[i]*dt[i];
+  y[i] = to.y - vel_y[i]*dt[i];
+}
+
+void Motion::advance(float step)
+{
+  assert(step >= 0);
+
+  const long n = size();
+  const float* __restrict ex = end_x.data();
+  const float* __restrict ey = end_y.data();
+  const float* __restrict vx = vel_x.data();
+  const float* __restrict vy = vel_y.data();
+  float* __restrict rdt = dt.data();
+  float* __restrict px = x.data();
+  float* __restrict py = y.data();
+
+  #pragma omp parallel for simd if(parallel: Idx(n) >= parallel_min_size) schedule(static)
+  for (long i = 0; i < n; ++i) {
+    const float d = std::max(rdt[i] - step, 0.f);
+    rdt[i] = d;
+    px[i] = ex[i] - vx[i]*d;
+    py[i] = ey[i] - vy[i]*d;
+  }
+}
@@ -1,11 +1,19 @@
 #include "../include/ofApp.hpp"
 
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
+#include <ranges>
+#include <sstream>
 
 #include "../include/param.hpp"
 
 #include "mapf_r/agent/plan/alg.hpp"
 
+#include "../include/timeline_io.hpp"
+
+#include <tomaqa.hpp>
+
 static pair<double, bool> get_scale(double w, double h)
 {
   auto window_max_w = default_screen_width - 2*screen_x_buffer - 2*window_x_buffer;
@@ -15,6 +23,76 @@ static pair<double, bool> get_scale(double w, double h)
   return {min(max_w, max_h) + 1, max_w < max_h};
 }
 
+// of the views side by side, shrunk to fit the screen as a single view does
+static Coord fit_views(Coord size, int n_views)
+{
+  const double max_w = max<double>(size.x, default_screen_width);
+  const double fit = min(1., max_w/(size.x*n_views));
+  return {size.x*n_views*fit, size.y*fit};
+}
+
+// fixed-function GLSL, the same as the default renderer
+static const string circles_vertex_shader = R"(
+#version 120
+
+attribute vec3 instance_offset;
+attribute vec4 instance_color;
+varying vec4 color;
+
+void main()
+{
+  color = instance_color;
+  vec2 pos = gl_Vertex.xy*instance_offset.z + instance_offset.xy;
+  gl_Position = gl_ModelViewProjectionMatrix*vec4(pos, 0., 1.);
+}
+)";
+
+static const string circles_fragment_shader = R"(
+#version 120
+
+varying vec4 color;
+
+void main()
+{
+  gl_FragColor = color;
+}
+)";
+
+// not to collide with the locations of built-in attributes
+static constexpr int circles_offset_attribute = 6;
+static constexpr int circles_color_attribute = 7;
+
+static const string heatmap_vertex_shader = R"(
+#version 120
+
+varying vec2 tex_coord;
+
+void main()
+{
+  tex_coord = gl_MultiTexCoord0.xy;
+  gl_Position = gl_ModelViewProjectionMatrix*gl_Vertex;
+}
+)";
+
+// relative to the hottest cell; the rows of the heat are from the bottom
+static const string heatmap_fragment_shader = R"(
+#version 120
+
+uniform sampler2D heat;
+uniform float scale_heat;
+uniform vec3 cold;
+uniform vec3 hot;
+varying vec2 tex_coord;
+
+void main()
+{
+  float a = texture2D(heat, vec2(tex_coord.x, 1. - tex_coord.y)).r*scale_heat;
+  gl_FragColor = vec4(mix(cold, hot, a), a > 0. ? (64. + 160.*a)/255. : 0.);
+}
+)";
+
+static const ofColor heatmap_cold(255, 235, 59), heatmap_hot(244, 67, 54);
+
 static void printKeys()
 {
   std::cout << "keys for visualizer" << std::endl;
@@ -24,10 +102,16 @@ static void printKeys()
   std::cout << "- v : show virtual line to goals" << std::endl;
   std::cout << "- f : show agent & vertex id" << std::endl;
   std::cout << "- g : show goals" << std::endl;
+  std::cout << "- h : accumulate and show the heatmap of occupancy" << std::endl;
+  std::cout << "- H : heatmap of the whole plan" << std::endl;
+  std::cout << "- x : show collisions" << std::endl;
+  std::cout << "- t : show timings of the phases of frames" << std::endl;
+  std::cout << "- z : pause at collisions" << std::endl;
   std::cout << "- right : progress" << std::endl;
   std::cout << "- left  : back" << std::endl;
   std::cout << "- up    : speed up" << std::endl;
   std::cout << "- down  : speed down" << std::endl;
+  std::cout << "- + / - : zoom in / out (or drag with the right button)" << std::endl;
   std::cout << "- space : screenshot (saved in Desktop)" << std::endl;
   std::cout << "- c : record to GIF (saved in Desktop)" << std::endl;
   std::cout << "- esc : terminate" << std::endl;
@@ -56,9 +140,7 @@ ofApp::ofApp(const Graph& g)
 ofApp::ofApp(const Graph& g, const agent::Layout& l, agent::plan::Global p)
     : ofApp(g, move(p), agent::plan::Global_states())
 {
-  states_plan = {plan, graph(), l};
-
-  makespan = plan.makespan();
+  layout_l = &l;
 
   const int n_agents = plan.size();
   agents.reserve(n_agents);
@@ -102,37 +184,135 @@ ofApp::ofApp(agent::plan::Global_states sp)
     : ofApp(nullptr, graph::make_properties(sp), sp)
 { }
 
-void ofApp::init()
+ofApp::ofApp(const Graph& g, Timeline tl)
+    : ofApp(&g, graph::make_properties(g), move(tl))
+{ }
+
+ofApp::ofApp(const Graph* gl, graph::Properties g_prop, Timeline tl)
+    : ofApp(gl, move(g_prop), agent::plan::Global(), agent::plan::Global_states())
 {
-  assert(plan.empty() || plan.size() == agents.size());
+  auto& timeline = playback().timeline;
+  timeline = move(tl);
+  makespan = timeline.makespan;
 
-  if (states_plan.empty()) return;
+  assert(!timeline.empty());
+  const int n_agents = timeline.size();
+  agents.reserve(n_agents);
+  for (int i = 0; i < n_agents; ++i) {
+    agent::Id aid = i;
+    assert(aid == int(agents.size()));
+    auto& start = timeline.ctrack(aid).front();
+    agents.emplace_back(aid, timeline.radii[aid], timeline.abs_vs[aid], Coord{start.x, start.y});
+  }
+
+  init();
+}
 
-  assert(states_plan.size() == agents.size());
+ofApp::ofApp(const Graph& g, unique_ptr<Timeline_stream> stream)
+    : ofApp(g, agent::plan::Global(), agent::plan::Global_states())
+{
+  stream_l = move(stream);
+  makespan = stream_l->makespan();
+
+  const int n_agents = stream_l->size();
+  assert(n_agents > 0);
+  agents.reserve(n_agents);
+  for (int i = 0; i < n_agents; ++i) {
+    agent::Id aid = i;
+    assert(aid == int(agents.size()));
+    auto& rec = stream_l->records[aid];
+    const auto start = stream_l->read_waypoint(aid, 0);
+    agents.emplace_back(aid, rec.radius, rec.abs_v, Coord{start.x, start.y});
+  }
 
+  loadStreamWindow(0, 0);
+
+  init();
+}
+
+// the agents stay at their goals forever
+static void finish_states_plan(agent::plan::Global_states& states_plan)
+{
   for (auto& [aid, splan] : states_plan) {
     auto& s = splan.back();
     assert(s.cduration() > 0 || s.idle());
     if (s.cduration() == 0) s.get_idle().set_duration(inf);
+    assert(splan.front().cduration() > 0);
   }
+}
 
-  std::cout << states_plan << std::endl;
+void ofApp::init()
+{
+  assert(plan.empty() || plan.size() == agents.size());
 
-  for (auto& ag : agents) {
-    auto& aid = ag.cid();
-    auto& states = states_plan.cat(aid);
-    auto& st = ag.state();
-    st = states.front();
-    assert(st == states.front());
-    assert(st.dt() == st.cduration());
-    assert(st.cduration() > 0);
-    first_switch_time_threshold = min<float>(first_switch_time_threshold, st.dt());
+  // otherwise the timeline is given directly
+  if (!statesPlan().empty()) {
+    assert(states_plan.size() == agents.size());
+    finish_states_plan(states_plan);
+    playback().timeline = make_timeline(states_plan);
+    // the timeline is what is played, of all the plans
+    assert(!layout_l || apx_equal(playback().timeline.makespan, float(plan.makespan())));
+    makespan = playback().timeline.makespan;
+    for (auto& pb : playbacks | std::views::drop(1)) makespan = max(makespan, pb.timeline.makespan);
+  }
+
+  if (playback().empty()) return;
+
+  initPlaybacks();
+  setupHeatmap();
+
+  seek(0);
+}
+
+// of the same agents, only its timeline is kept;
+// before `setup`, which sizes the window by the number of the plans
+void ofApp::comparePlan(const agent::plan::Global& p, string name)
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  assert(layout_l);
+  expect(p.size() == agents.size(), "The compared plans differ in the number of agents: "s + name);
+
+  agent::plan::Global_states splan{p, graph(), *layout_l};
+  finish_states_plan(splan);
+
+  auto& pb = playbacks.emplace_back();
+  pb.name = move(name);
+  pb.timeline = make_timeline(splan);
+  makespan = max(makespan, pb.timeline.makespan);
+
+  initPlaybacks();
+  seek(curr_time);
+}
+
+// after any of the timelines has changed
+void ofApp::initPlaybacks()
+{
+  paths.resize(playbacks.size());
+  for (size_t i = 0; i < playbacks.size(); ++i) {
+    auto& pb = playbacks[i];
+    assert(pb.size() == agents.size());
+    pb.makespan = makespan;
+    pb.init();
+    paths[i].dirty = true;
   }
+}
 
-  agents_action_idx.resize(agents.size());
+// the agents stay, only their states change
+void ofApp::setPlan(agent::plan::Global p)
+{
+  assert(layout_l);
+  assert(p.size() == agents.size());
+
+  plan = move(p);
+  states_plan = {};
+  init();
 
-  assert(first_switch_time_threshold <= makespan);
-  switch_time_threshold = first_switch_time_threshold;
+  timestep_slider.setMax(makespan);
+  // the goals may have changed
+  buildGraphLayer();
+  reset();
 }
 
 template <typename T>
@@ -170,6 +350,26 @@ Coord ofApp::adjusted_pos_of(const T& t) const
   return adjusted_pos(t.cpos());
 }
 
+Coord ofApp::adjusted_pos_of_agent(const Playback& pb, const agent::Id& aid) const
+{
+  return adjusted_pos(Coord{pb.motion.x[aid], pb.motion.y[aid]});
+}
+
+// the plans side by side, each showing the whole graph
+ofRectangle ofApp::viewport(int idx) const
+{
+  // of the whole window, which may have been scaled
+  if (playbacks.size() == 1) return ofGetCurrentViewport();
+
+  const float w = float(ofGetWidth())/playbacks.size();
+  return ofRectangle(idx*w, 0, w, ofGetHeight());
+}
+
+bool ofApp::headless() const
+{
+  return !render_config.output.empty();
+}
+
 bool ofApp::recording() const
 {
   if (!flg_record) return false;
@@ -178,29 +378,31 @@ bool ofApp::recording() const
   return true;
 }
 
-bool ofApp::screenshot_or_recording() const
-{
-  return flg_screenshot || recording();
-}
-
 void ofApp::setup()
 {
   const auto [mx, my] = window_min();
   const auto [w, h] = window_size();
-  ofSetWindowShape(w, h);
+  // each view keeps the aspect of a single one, so the camera shows the same
+  const int n_views = playbacks.size();
+  const auto [views_w, views_h] = fit_views({w, h}, n_views);
+  ofSetWindowShape(views_w, views_h);
   ofBackground(Color::bg);
   ofDisableAlphaBlending();
-  ofSetCircleResolution(32);
-  ofSetFrameRate(30);
+  ofSetCircleResolution(agent_circle_resolution);
+  // headless rendering is not bound to the real-time clock
+  ofSetFrameRate(headless() ? 0 : 30);
+  ofSetVerticalSync(!headless());
   font.load("MuseoModerno-VariableFont_wght.ttf", font_size, true, false, true);
 
-  assert(int(w) == ofGetWidth());
-  assert(int(h) == ofGetHeight());
+  assert(int(views_w) == ofGetWidth());
+  assert(int(views_h) == ofGetHeight());
 
   // setup gui
   gui_panel.setup();
   gui_panel.add(timestep_slider.setup("time step", 0, 0, makespan));
+  timestep_slider.addListener(this, &ofApp::onTimestepChanged);
   gui_panel.add(speed_slider.setup("speed", 0.05, 0, 1.));
+  if (pending_plan.valid()) gui_panel.add(solve_label.setup("solving", ""));
 
   cam.setVFlip(true);
   const float cam_w = w + 2*mx;
@@ -209,55 +411,141 @@ void ofApp::setup()
   cam.setGlobalPosition(ofVec3f(cam_w/2, cam_h/2, cam_z));
   cam.removeAllInteractions();
   cam.addInteraction(ofEasyCam::TRANSFORM_TRANSLATE_XY, OF_MOUSE_BUTTON_LEFT);
+  cam.addInteraction(ofEasyCam::TRANSFORM_TRANSLATE_Z, OF_MOUSE_BUTTON_RIGHT);
+  cam.setFarClip(cam_z*1000);
+  // all the viewports move together
+  cam.setControlArea(ofRectangle(0, 0, views_w, views_h));
+
+  // in world coordinates, so independent of the camera
+  setupCirclesShader();
+  buildGraphLayer();
+  setupGraphLayers();
+  setupAgentsInstancing();
+  setupHeatmapShader();
+  buildAgentsLabels();
 
   // the sizes do not matter too much, it always gets the full view
   // .. but also always with some white borders ..
-  record_fbo.allocate(w, h, GL_RGB);
-  gif_encoder.setup(w, h, 1./ofGetTargetFrameRate());
+  record_fbo.allocate(views_w, views_h, GL_RGB);
+  for (auto& pbo : record_pbos) {
+    pbo.allocate(record_fbo.getWidth()*record_fbo.getHeight()*3, GL_STREAM_READ);
+  }
+  const float record_fps = headless() ? render_config.fps : ofGetTargetFrameRate();
+  gif_encoder.setup(views_w, views_h, 1./record_fps);
   ofAddListener(ofxGifEncoder::OFX_GIF_SAVE_FINISHED, this, &ofApp::onGifSaved);
 
-  printKeys();
+  if (headless()) setupHeadless();
+  else {
+    printKeys();
+    watchFiles();
+  }
 
-  assert(int(w) == ofGetWidth());
-  assert(int(h) == ofGetHeight());
+  assert(int(views_w) == ofGetWidth());
+  assert(int(views_h) == ofGetHeight());
   // .. but later it will most likely not hold any more, probably because of window scaling etc.
 }
 
+void ofApp::setupHeadless()
+{
+  assert(render_config.fps > 0);
+  assert(render_config.speed > 0);
+
+  gui_panel.minimize();
+  speed_slider = render_config.speed;
+  flg_record = true;
+
+  if (render_config.n_chunks > 1) setupHeadlessChunk();
+
+  cout << "rendering to " << render_config.output << " ..." << endl;
+}
+
+// the frames are at the multiples of the speed, as if rendered in one pass
+void ofApp::setupHeadlessChunk()
+{
+  const int i = render_config.chunk;
+  const int n = render_config.n_chunks;
+  assert(i >= 0 && i < n);
+
+  const long n_frames = long(makespan/render_config.speed) + 1;
+  const long begin = n_frames*i/n;
+  const long end = n_frames*(i+1)/n;
+  // the last chunk finishes as usual, in case of rounding errors
+  render_frames_left = (i+1 < n) ? end - begin : -1;
+
+  if (playback().empty()) return;
+  seek(begin*render_config.speed);
+}
+
 void ofApp::reset()
 {
   flg_record = false;
 
-  timestep_slider = 0;
+  setTime(0);
 
   finished = false;
 
   recording_may_start = false;
 
-  gif_encoder.stop();
-  // gif_encoder.waitForThread();
-  gif_encoder.reset();
+  dropRecord();
 
-  if (states_plan.empty()) return;
+  heatmap.clear();
+  heatmap_dirty = true;
 
-  switch_time_threshold = first_switch_time_threshold;
-  for (auto& ag : agents) {
-    auto& aid = ag.cid();
-    ag.state() = states_plan.cat(aid).front();
-    agents_action_idx[aid] = 0;
+  if (playback().empty()) return;
+
+  seek(0);
+}
+
+void ofApp::setTime(float t)
+{
+  curr_time = t;
+  // does not seek, see `onTimestepChanged`
+  timestep_slider = t;
+}
+
+void ofApp::seek(float t)
+{
+  if (playback().empty()) return;
+
+  t = std::clamp(t, 0.f, makespan);
+  finished = false;
+
+  if (stream_l && (t < stream_window_begin || t >= stream_window_end)) {
+    loadStreamWindow(t, t);
   }
+
+  for (auto& pb : playbacks) pb.seek(t);
+  updateSwitchTimeThreshold();
+
+  setTime(t);
+}
+
+void ofApp::loadStreamWindow(float t_begin, float t_end)
+{
+  assert(stream_l);
+  auto window = stream_l->take(t_begin, t_end);
+  playback().timeline = move(window.timeline);
+  stream_window_begin = window.begin;
+  stream_window_end = window.end;
+  for (auto& p : paths) p.dirty = true;
 }
 
 template <ofApp::StepMode modeV>
 void ofApp::doStep(float step)
 {
-  static_assert(modeV != StepMode::partial);
-  return doStepImpl<modeV>(step, timestep_slider, timestep_slider+step);
+  // the actions after the end of the window are not known
+  if (stream_l && curr_time+step >= stream_window_end) {
+    loadStreamWindow(curr_time, curr_time+step);
+    seek(curr_time);
+  }
+
+  return doStepImpl<modeV>(curr_time, curr_time+step);
 }
 
 template <ofApp::StepMode modeV>
-void ofApp::doStepImpl(float step, float t, float t_next)
+void ofApp::doStepImpl(float t, float t_next)
 {
-  if (states_plan.empty()) return;
+  if (playback().empty()) return;
   if (finished) return;
 
   recording_may_start = true;
@@ -269,226 +557,1003 @@ void ofApp::doStepImpl(float step, float t, float t_next)
     return;
   }
 
-  [[maybe_unused]] const bool finish = t_next > makespan;
-  if constexpr (modeV == StepMode::partial) {
-    assert(!finish);
+  // all the switches within the step in one pass
+  while (t_next >= switch_time_threshold && t < switch_time_threshold) {
+    const float threshold = switch_time_threshold;
+    doStepAdvanceAgs(threshold - t);
+    doStepSwitch(threshold - t);
+    t = threshold;
+    if (modeV == StepMode::manual || t_next == threshold) {
+      setTime(t);
+      return;
+    }
   }
-  else if (finish) {
-    assert(t_next >= switch_time_threshold);
 
+  if (t_next > makespan) {
     if (flg_loop) {
       reset();
       return;
     }
 
     doStepAdvanceAgs(makespan - t);
-    timestep_slider = makespan;
+    setTime(makespan);
     onFinish();
     return;
   }
 
-  const bool do_switch = t_next >= switch_time_threshold;
-  if (!do_switch) {
-    doStepAdvanceAgs(step);
-    timestep_slider = t_next;
-    return;
+  doStepAdvanceAgs(t_next - t);
+  setTime(t_next);
+}
+
+// also used by the benchmarks
+template void ofApp::doStep<ofApp::StepMode::def>(float);
+
+void ofApp::doStepAdvanceAgs(float step)
+{
+  const auto scope = profiler.scope(Profiler::Phase::advance);
+
+  for (auto& pb : playbacks) pb.advance(step);
+
+  if (!flg_heatmap) return;
+  // of the first plan only
+  auto& pb = playback();
+  heatmap.add(pb.motion.x, pb.motion.y, pb.timeline.radii, step);
+  heatmap_dirty = true;
+}
+
+void ofApp::doStepSwitch(float step)
+{
+  const auto scope = profiler.scope(Profiler::Phase::switch_);
+
+  // only the agents whose actions end right now
+  for (auto& pb : playbacks) {
+    if (pb.switch_time_threshold > switch_time_threshold) continue;
+    profiler.add_switches(pb.switch_actions());
   }
 
-  const float partial_step = switch_time_threshold - t;
-  const float prev_switch_time_threshold = switch_time_threshold;
-  doStepAdvanceAgs(partial_step);
-  doStepSwitch(partial_step);
-  if (modeV == StepMode::manual || t_next == prev_switch_time_threshold) {
-    timestep_slider = prev_switch_time_threshold;
-    return;
+  updateSwitchTimeThreshold();
+}
+
+void ofApp::updateSwitchTimeThreshold()
+{
+  switch_time_threshold = t_inf;
+  for (auto& pb : playbacks) {
+    switch_time_threshold = min(switch_time_threshold, pb.switch_time_threshold);
   }
+  assert(switch_time_threshold <= makespan);
+}
+
+void ofApp::update()
+{
+  // the previous update and draw
+  profiler.end_frame(curr_time);
+
+  if (headless()) return updateHeadless();
+
+  updatePendingPlan();
+  updatePlanSocket();
+  updateFileWatch();
+
+  if (flg_autoplay) doStep(speed_slider);
 
-  step = t_next - prev_switch_time_threshold;
-  return doStepImpl<StepMode::partial>(step, prev_switch_time_threshold, t_next);
+  updateCollisions();
 }
 
-void ofApp::doStepAdvanceAgs(float step)
+void ofApp::updateCollisions()
 {
-  for (auto& ag : agents) {
-    ag.state().advance(step);
+  bool started = false;
+  for (auto& pb : playbacks) {
+    if (!flg_collisions) {
+      pb.collisions.pairs.clear();
+      continue;
+    }
+
+    const bool had_collisions = !pb.collisions.empty();
+    pb.detect_collisions();
+    // reported only when they start
+    if (pb.collisions.empty() || had_collisions) continue;
+    started = true;
+
+    cout << "collision";
+    if (playbacks.size() > 1) cout << " in " << pb.name;
+    cout << " at " << curr_time << ":";
+    for (auto& [i, j] : pb.collisions.pairs) cout << " (" << i << ", " << j << ")";
+    cout << endl;
   }
+
+  if (started && flg_collision_pause) flg_autoplay = false;
 }
 
-void ofApp::doStepSwitch(float step)
+void ofApp::updatePendingPlan()
 {
-  for (auto& ag : agents) {
-    auto& aid = ag.cid();
-    auto& st = ag.state();
+  if (!pending_plan.valid()) return;
+
+  using namespace std::chrono_literals;
+  if (pending_plan.wait_for(0s) != std::future_status::ready) {
+    if (solve_log_l) solve_label = solve_log_l->last_line();
+    return;
+  }
+
+  // swapped between frames, so never drawn half-way
+  agent::plan::Global solved;
+  // the agents stay at their starts then
+  try {
+    solved = pending_plan.get();
+  }
+  catch (const Error& err) {
+    cerr << "the plan was not solved: " << err << endl;
+    solve_label = "failed";
+    return;
+  }
+  // e.g. `bad_alloc` of the solver
+  catch (const std::exception& e) {
+    cerr << "the plan was not solved: " << e.what() << endl;
+    solve_label = "failed";
+    return;
+  }
 
-    auto& curr_action_idx = agents_action_idx[aid];
-    const auto& states = states_plan.cat(aid);
-    if (curr_action_idx == states.size()) continue;
-    assert(st.cend_pos() == states[curr_action_idx].cend_pos());
-    assert(st.cduration() == states[curr_action_idx].cduration());
+  setPlan(move(solved));
+  solve_label = plan.makespan() > 0 ? "done" : "no plan";
+  dumpPlan();
+}
 
-    const auto dt = st.dt();
-    if (apx_greater(dt, 0) && float(switch_time_threshold + dt) > switch_time_threshold) continue;
+// the loaded tracks are only appended to
+void ofApp::updatePlanSocket()
+{
+  if (!plan_socket.is_open()) return;
 
-    const auto to_pos = st.cend_pos();
-    assert(apx_equal<precision::Low>(st.cpos(), to_pos));
+  plan_appends.clear();
+  plan_socket.poll(plan_appends);
+  if (plan_appends.empty()) return;
 
-    if (++curr_action_idx == states.size()) {
-      ag.set_idle_state(to_pos, inf);
+  // only the appended agents are updated, not the whole plan
+  auto& live = playback();
+  for (auto& [aid, waypoint] : plan_appends) {
+    if (aid >= live.size() || waypoint.t < live.timeline.ctrack(aid).back().t) {
+      cerr << "dropped waypoint of agent " << aid << " at " << waypoint.t << endl;
       continue;
     }
+    live.append(aid, waypoint, curr_time);
+    appendPath(0, aid);
+  }
 
-    st = states[curr_action_idx];
-    assert(st == states[curr_action_idx]);
-    assert(apx_equal<precision::Huge>(st.cpos(), to_pos));
-    assert(st.cduration() > 0);
+  if (live.timeline.makespan > makespan) {
+    makespan = live.timeline.makespan;
+    timestep_slider.setMax(makespan);
+    finished = false;
+  }
+  for (auto& pb : playbacks) {
+    pb.makespan = makespan;
+    pb.update_switch_time_threshold();
   }
+  updateSwitchTimeThreshold();
+}
 
-  switch_time_threshold = min(agents, [&](auto& ag) -> float {
-    auto& aid = ag.cid();
-    auto& curr_action_idx = agents_action_idx[aid];
-    const auto& states = states_plan.cat(aid);
-    if (curr_action_idx == states.size()) return t_inf;
-    const float thres = switch_time_threshold + ag.cstate().dt();
-    assert(thres > switch_time_threshold);
-    return thres;
-  });
+// in the order of adding
+enum Watched_file { graph_file, plan_file, layout_file };
+
+void ofApp::watchFiles()
+{
+  if (plan_fn.empty()) return;
+
+  // a binary plan stays mapped, so it must be replaced by renaming, as `spb::save` does;
+  // the old mapping then keeps the previous plan to compare with
+  file_watch.open();
+  // without a graph, the plan takes its place, so that the indices stay
+  file_watch.add(graph_fn.empty() ? plan_fn : graph_fn);
+  file_watch.add(plan_fn);
+  if (!layout_fn.empty()) file_watch.add(layout_fn);
+}
 
-  if (switch_time_threshold > makespan) {
-    assert(apx_equal<precision::Low>(switch_time_threshold, makespan) || switch_time_threshold == t_inf);
-    switch_time_threshold = makespan;
+void ofApp::updateFileWatch()
+{
+  if (!file_watch.is_open()) return;
+
+  const auto changed = file_watch.poll();
+  if (changed.empty()) return;
+
+  const auto has = [&changed](Watched_file file){ return std::ranges::count(changed, file) > 0; };
+  if (has(graph_file) && !graph_fn.empty()) {
+    cerr << "the graph has changed, restart to reload it" << endl;
+  }
+  if (!has(plan_file) && !has(layout_file)) return;
+
+  // the files may be broken while being regenerated
+  try {
+    reloadPlan(has(layout_file));
+  }
+  catch (const Error& err) {
+    cerr << "the plan was not reloaded: " << err << endl;
   }
 }
 
-void ofApp::update()
+// the plan is parsed anew, but only the agents whose tracks changed are reset
+void ofApp::reloadPlan(bool layout_changed)
 {
-  if (!flg_autoplay) return;
+  using namespace tomaqa;
+  using namespace std;
 
-  doStep(speed_slider);
+  const auto ext = filesystem::path(plan_fn).extension();
+  if (ext == ".spb") {
+    return reloadTimeline(spb::load(plan_fn));
+  }
+
+  ifstream p_ifs(plan_fn);
+  expect(p_ifs.good(), "Plan file not readable: "s + plan_fn);
+
+  // as given, without a layout
+  if (layout_fn.empty()) {
+    agent::plan::Global_states splan(p_ifs);
+    finish_states_plan(splan);
+    reloadTimeline(make_timeline(splan));
+    states_plan = move(splan);
+    return;
+  }
+
+  assert(layout_l);
+  unique_ptr<agent::Layout> new_layout_ptr{};
+  if (layout_changed) {
+    ifstream l_ifs(layout_fn);
+    expect(l_ifs.good(), "Layout file not readable: "s + layout_fn);
+    new_layout_ptr = make_unique<agent::Layout>(l_ifs);
+  }
+  const agent::Layout& layout = new_layout_ptr ? *new_layout_ptr : *layout_l;
+
+  agent::plan::Global p(p_ifs);
+  agent::plan::Global_states splan{p, graph(), layout};
+  finish_states_plan(splan);
+  reloadTimeline(make_timeline(splan));
+  plan = move(p);
+  states_plan = move(splan);
+
+  if (!new_layout_ptr) return;
+  layout_ptr = move(new_layout_ptr);
+  layout_l = layout_ptr.get();
+  // the goals may have changed
+  buildGraphLayer();
 }
 
-static void set_agent_color(const agent::Id& aid)
+// the playback continues at the same time, the view stays
+void ofApp::reloadTimeline(Timeline tl)
 {
-  ofSetColor(Color::agents[aid % Color::agents.size()]);
+  using namespace tomaqa;
+  using namespace std;
+
+  auto& timeline = playback().timeline;
+  expect(tl.size() == agents.size(), "The reloaded plan differs in the number of agents.");
+
+  size_t n_changed = 0;
+  for (size_t aid = 0; aid < tl.size(); ++aid) {
+    const auto& new_track = tl.ctrack(aid);
+    const float radius = tl.radii[aid], abs_v = tl.abs_vs[aid];
+    if (std::ranges::equal(timeline.ctrack(aid), new_track)
+        && timeline.radii[aid] == radius && timeline.abs_vs[aid] == abs_v) continue;
+    ++n_changed;
+
+    const auto start = new_track.front();
+    agents[aid] = Agents::value_type(aid, radius, abs_v, Coord{start.x, start.y});
+  }
+
+  cout << "reloaded " << plan_fn << ": " << n_changed << " agents changed" << endl;
+  if (n_changed == 0) return;
+
+  // also a mapped one, the tracks of the same agents are equal
+  timeline = move(tl);
+
+  makespan = 0;
+  for (auto& pb : playbacks) makespan = max(makespan, pb.timeline.makespan);
+  for (auto& pb : playbacks) pb.makespan = makespan;
+  timestep_slider.setMax(makespan);
+  paths.front().dirty = true;
+  seek(curr_time);
 }
 
-void ofApp::draw()
+// of the plan of the layout by mapf_r, unless given directly
+const agent::plan::Global_states& ofApp::statesPlan()
 {
-  const auto [w, h] = window_size();
-  const auto [mx, my] = window_min();
+  if (states_plan.empty() && layout_l) {
+    states_plan = {plan, graph(), *layout_l};
+    finish_states_plan(states_plan);
+  }
+  return states_plan;
+}
 
-  if (recording()) {
-    record_fbo.begin();
-    ofClear(Color::bg);
+void ofApp::dumpPlan()
+{
+  if (plan_dump_output.empty() || statesPlan().empty()) return;
+
+  using namespace tomaqa;
+  using namespace std;
+
+  if (plan_dump_output == "-") {
+    cout << states_plan << endl;
+    return;
   }
 
-  cam.begin();
+  ofstream ofs(plan_dump_output);
+  expect(ofs.good(), "Plan dump file not writable: "s + plan_dump_output);
+  ofs << states_plan << endl;
+}
 
-  if (flg_screenshot) {
-    ofBeginSaveScreenAsPDF(ofFilePath::getUserHomeDir()
-                           + "/Desktop/screenshot-" + ofGetTimestampString()
-                           + ".pdf",
-                           /*multipage*/ false, /*3D*/ false,
-                           // it seems that when starting pos. > 0 only draws border elsewhere
-                           // but the actual size of the figure does not change ...
-                           ofRectangle(0, 0, w + mx*2, h + my*2)
-    );
+void ofApp::updateHeadless()
+{
+  // the record is being saved in `onFinish`, `exit` waits for it
+  if (finished || playback().empty()) return ofExit();
+
+  if (render_frames_left == 0) return onFinish();
+  if (render_frames_left > 0) --render_frames_left;
+
+  // the very first frame captures the initial state
+  if (!recording_may_start) {
+    recording_may_start = true;
+    return;
   }
 
-  // draw edges
-  ofSetLineWidth(line_width);
-  if (graph_l)
-  for (auto& vertex : graph().cvertices()) {
-    auto& vid = vertex.cid();
+  doStep(render_config.speed);
+}
+
+static const ofColor& agent_color(const agent::Id& aid)
+{
+  return Color::agents[aid % Color::agents.size()];
+}
+
+static void set_agent_color(const agent::Id& aid)
+{
+  ofSetColor(agent_color(aid));
+}
+
+// the camera only translates, so the corners of the viewport suffice
+void ofApp::updateView(const ofRectangle& viewport)
+{
+  // the graph lies in the plane z = 0
+  const auto on_plane = [this, &viewport](float sx, float sy){
+    const glm::vec3 near = cam.screenToWorld({sx, sy, -1}, viewport);
+    const glm::vec3 far = cam.screenToWorld({sx, sy, 1}, viewport);
+    return glm::mix(near, far, near.z/(near.z - far.z));
+  };
+  const glm::vec3 p0 = on_plane(viewport.x, viewport.y);
+  const glm::vec3 p1 = on_plane(viewport.x + viewport.width, viewport.y + viewport.height);
+  visible_rect = ofRectangle(glm::min(p0, p1), glm::max(p0, p1));
+  pixels_per_unit = visible_rect.width > 0 ? viewport.width/visible_rect.width : 1;
+}
+
+bool ofApp::visible(const ofRectangle& rect) const
+{
+  return visible_rect.intersects(rect);
+}
+
+bool ofApp::visible(float x, float y, float r) const
+{
+  return x + r >= visible_rect.getMinX() && x - r <= visible_rect.getMaxX()
+      && y + r >= visible_rect.getMinY() && y - r <= visible_rect.getMaxY();
+}
+
+void ofApp::zoom(float factor)
+{
+  assert(factor > 0);
+  auto pos = cam.getGlobalPosition();
+  // from a single cell to the whole map far away
+  pos.z = std::clamp<float>(pos.z/factor, scale, cam.getFarClip()/2);
+  cam.setGlobalPosition(pos);
+}
+
+void ofApp::buildGraphLayer()
+{
+  graph_tiles.clear();
+
+  if (!graph_l) return;
+
+  const auto& vertices = graph().cvertices();
+  glm::vec2 min_pos(std::numeric_limits<float>::max());
+  glm::vec2 max_pos(std::numeric_limits<float>::lowest());
+  for (auto& vertex : vertices) {
     const Coord pos = adjusted_pos_of(vertex);
+    min_pos = glm::min(min_pos, glm::vec2(pos.x, pos.y));
+    max_pos = glm::max(max_pos, glm::vec2(pos.x, pos.y));
+  }
+
+  // as many tiles along both axes, so they are dense if the graph is
+  const int n_tiles_1d = max(1, int(ceil(sqrt(double(vertices.size())/graph_tile_vertices))));
+  const glm::vec2 tile_size = glm::max((max_pos - min_pos)/float(n_tiles_1d), glm::vec2(1));
+  graph_tiles.resize(n_tiles_1d*n_tiles_1d);
+  const auto tile_of = [&](const Coord& pos) -> Graph_tile& {
+    const glm::ivec2 idx = glm::clamp(glm::ivec2((glm::vec2(pos.x, pos.y) - min_pos)/tile_size),
+                                      glm::ivec2(0), glm::ivec2(n_tiles_1d-1));
+    return graph_tiles[idx.y*n_tiles_1d + idx.x];
+  };
+
+  Vector<pair<glm::vec2, glm::vec2>> tiles_extent(graph_tiles.size(), {
+    glm::vec2(std::numeric_limits<float>::max()), glm::vec2(std::numeric_limits<float>::lowest())
+  });
+  // per tile: x, y, radius of each vertex, uploaded then
+  Vector<Vector<glm::vec3>> tiles_instances(graph_tiles.size());
+  for (auto& tile : graph_tiles) {
+    tile.edges_mesh.setMode(OF_PRIMITIVE_LINES);
+    tile.edges_mesh.setUsage(GL_STATIC_DRAW);
+  }
 
+  for (auto& vertex : vertices) {
+    auto& vid = vertex.cid();
+    const Coord pos = adjusted_pos_of(vertex);
+    const glm::vec3 center(pos.x, pos.y, 0);
+    auto& tile = tile_of(pos);
+    const size_t tile_idx = &tile - graph_tiles.data();
+    auto& [tile_min, tile_max] = tiles_extent[tile_idx];
+    tile_min = glm::min(tile_min, glm::vec2(center));
+    tile_max = glm::max(tile_max, glm::vec2(center));
+
+    // edges belong to the tile of their lower vertex
     for (auto& nid : vertex.cneighbor_ids()) {
       assert(nid != vid);
       if (vid > nid) continue;
       auto& neighbor = graph().cvertex(nid);
       const Coord npos = adjusted_pos_of(neighbor);
-      ofSetColor(Color::edge);
-      ofDrawLine(pos.x, pos.y, npos.x, npos.y);
+      tile.edges_mesh.addVertex(center);
+      tile.edges_mesh.addVertex(glm::vec3(npos.x, npos.y, 0));
+      tile_min = glm::min(tile_min, glm::vec2(npos.x, npos.y));
+      tile_max = glm::max(tile_max, glm::vec2(npos.x, npos.y));
+    }
+
+    //+ support also with states_plan only
+    const agent::Id* aid_l = plan.find_agent_id_of_goal(vid);
+    tile.goal_colors.push_back(aid_l ? agent_color(*aid_l) : Color::vertex);
+
+    tiles_instances[tile_idx].emplace_back(pos.x, pos.y, vertex_rad);
+    tile.vertex_ids.push_back(vid);
+  }
+
+  // unit circle as a triangle fan, its center alone is the point
+  constexpr int res = vertex_circle_resolution;
+  Vector<glm::vec3> circle;
+  if (shaded_circles) {
+    circle.reserve(res+2);
+    circle.emplace_back(0, 0, 0);
+    for (int i = 0; i <= res; ++i) {
+      const float angle = TWO_PI*i/res;
+      circle.emplace_back(cos(angle), sin(angle), 0);
     }
   }
 
-  // draw agents
-  for (auto& ag : agents) {
-    auto& aid = ag.cid();
-    auto& st = ag.cstate();
-    const Coord pos = adjusted_pos_of(st);
-    set_agent_color(aid);
-    ofDrawCircle(pos.x, pos.y, scaled(ag.cradius()));
-
-    /*
-    // goal
-    if (line_mode == LINE_MODE::STRAIGHT) {
-      ofDrawLine(goals[i]->x * scale + window_x_buffer + scale / 2,
-                 goals[i]->y * scale + window_y_top_buffer + scale / 2, x, y);
-    } else if (line_mode == LINE_MODE::PATH) {
-      // next loc
-      ofSetLineWidth(2);
-      if (t2 <= T) {
-        auto u = P->at(t2)[i];
-        ofDrawLine(x, y, u->x * scale + window_x_buffer + scale / 2,
-                   u->y * scale + window_y_top_buffer + scale / 2);
+  // with the labels and the widths of the primitives
+  const float pad = max<float>(vertex_rad, line_width) + font_size*4;
+  for (size_t i = 0; i < graph_tiles.size(); ++i) {
+    auto& [tile_min, tile_max] = tiles_extent[i];
+    auto& tile = graph_tiles[i];
+    tile.bounds = ofRectangle(glm::vec3(tile_min - pad, 0), glm::vec3(tile_max + pad, 0));
+
+    // otherwise drawn one by one from the graph
+    auto& instances = tiles_instances[i];
+    if (!shaded_circles || instances.empty()) continue;
+    auto& vbo = tile.vertices_vbo;
+    vbo.setVertexData(circle.data(), circle.size(), GL_STATIC_DRAW);
+    vbo.setAttributeData(circles_offset_attribute, &instances[0].x, 3, instances.size(),
+                         GL_STATIC_DRAW, sizeof(glm::vec3));
+    vbo.setAttributeDivisor(circles_offset_attribute, 1);
+    // the colors are set by the flags
+    const Vector<ofFloatColor> colors(instances.size());
+    vbo.setAttributeData(circles_color_attribute, &colors[0].r, 4, colors.size(),
+                         GL_STATIC_DRAW, sizeof(ofFloatColor));
+    vbo.setAttributeDivisor(circles_color_attribute, 1);
+  }
+  std::erase_if(graph_tiles, [](auto& tile){ return tile.goal_colors.empty(); });
+
+  updateGraphLayerColors();
+}
+
+// only the colors depend on the flags, the geometry stays
+void ofApp::updateGraphLayerColors()
+{
+  if (!shaded_circles) return;
+
+  Vector<ofFloatColor> colors;
+  for (auto& tile : graph_tiles) {
+    colors.clear();
+    colors.reserve(tile.goal_colors.size());
+    for (auto& goal_color : tile.goal_colors) {
+      colors.emplace_back(flg_goal ? goal_color : Color::vertex);
+    }
+    tile.vertices_vbo.updateAttributeData(circles_color_attribute, &colors[0].r, colors.size());
+  }
+}
+
+void ofApp::drawEdges()
+{
+  const auto scope = profiler.scope(Profiler::Phase::edges);
+  ofSetLineWidth(line_width);
+  ofSetColor(Color::edge);
+  for (auto& tile : graph_tiles) {
+    if (visible(tile.bounds)) tile.edges_mesh.draw();
+  }
+}
+
+void ofApp::drawVertices()
+{
+  // level of detail
+  const float rad_px = vertex_rad*pixels_per_unit;
+  if (rad_px >= vertex_skip_radius_px) {
+    const auto scope = profiler.scope(Profiler::Phase::vertices);
+    const bool as_points = rad_px < vertex_point_radius_px;
+    if (shaded_circles) {
+      if (as_points) glPointSize(1);
+      circles_shader.begin();
+      for (auto& tile : graph_tiles) {
+        if (!visible(tile.bounds)) continue;
+        const int n_vertices = tile.goal_colors.size();
+        auto& vbo = tile.vertices_vbo;
+        if (as_points) vbo.drawInstanced(GL_POINTS, 0, 1, n_vertices);
+        else vbo.drawInstanced(GL_TRIANGLE_FAN, 0, vbo.getNumVertices(), n_vertices);
       }
-      for (int t = t1 + 1; t < T; ++t) {
-        auto v_from = P->at(t)[i];
-        auto v_to = P->at(t + 1)[i];
-        if (v_from == v_to) continue;
-        ofDrawLine(v_from->x * scale + window_x_buffer + scale / 2,
-                   v_from->y * scale + window_y_top_buffer + scale / 2,
-                   v_to->x * scale + window_x_buffer + scale / 2,
-                   v_to->y * scale + window_y_top_buffer + scale / 2);
+      circles_shader.end();
+    }
+    else {
+      for (auto& tile : graph_tiles) {
+        if (!visible(tile.bounds)) continue;
+        for (size_t i = 0; i < tile.vertex_ids.size(); ++i) {
+          const Coord pos = adjusted_pos_of(graph().cvertex(tile.vertex_ids[i]));
+          ofSetColor(flg_goal ? tile.goal_colors[i] : Color::vertex);
+          ofDrawCircle(pos.x, pos.y, vertex_rad);
+        }
       }
-      ofSetLineWidth(1);
     }
+  }
 
-    // agent at goal
-    if (v == goals[i]) {
-      ofSetColor(255, 255, 255);
-      ofDrawCircle(x, y, agent_rad * 0.7);
-    }
+  if (!drawingLabels()) return;
+
+  const auto labels_scope = profiler.scope(Profiler::Phase::labels);
+  ofSetColor(Color::font);
+  for (auto& tile : graph_tiles) {
+    if (!visible(tile.bounds)) continue;
+    // built only once shown, most of the tiles of large graphs never are
+    if (tile.labels_mesh.getNumVertices() == 0) buildLabelsMesh(tile);
+    drawLabelsMesh(tile.labels_mesh);
+  }
+}
 
-    // id
-    if (flg_font) {
-      ofSetColor(Color::font);
-      font.drawString(std::to_string(i), x - font_size / 2, y + font_size / 2);
+void ofApp::buildLabelsMesh(Graph_tile& tile)
+{
+  auto& mesh = tile.labels_mesh;
+  mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+  mesh.setUsage(GL_STATIC_DRAW);
+  for (auto& vid : tile.vertex_ids) {
+    const Coord pos = adjusted_pos_of(graph().cvertex(vid));
+    mesh.append(font.getStringMesh(std::to_string(vid), pos.x - vertex_rad/2, pos.y - vertex_rad/2 + font_size));
+  }
+}
+
+void ofApp::setupHeatmap()
+{
+  const auto& timeline = playback().timeline;
+  float max_r = 0;
+  for (float r : timeline.radii) max_r = max(max_r, r);
+
+  glm::vec2 min_pos(std::numeric_limits<float>::max());
+  glm::vec2 max_pos(std::numeric_limits<float>::lowest());
+  if (graph_l) {
+    min_pos = glm::vec2(graph_prop.min.x, graph_prop.min.y);
+    max_pos = glm::vec2(graph_prop.max.x, graph_prop.max.y);
+  }
+  else {
+    for (auto& track : timeline.tracks) for (auto& w : track) {
+      min_pos = glm::min(min_pos, glm::vec2(w.x, w.y));
+      max_pos = glm::max(max_pos, glm::vec2(w.x, w.y));
     }
-    */
   }
 
-  // draw vertices
-  if (graph_l)
-  for (auto& vertex : graph().cvertices()) {
-    auto& vid = vertex.cid();
-    const Coord pos = adjusted_pos_of(vertex);
+  heatmap.setup(min_pos.x - max_r, min_pos.y - max_r, max_pos.x + max_r, max_pos.y + max_r,
+                heatmap_max_cells);
+  heatmap_dirty = true;
+}
 
-    //+ support also with states_plan only
-    if (const agent::Id* aid_l; flg_goal && (aid_l = plan.find_agent_id_of_goal(vid))) {
-      set_agent_color(*aid_l);
+// offline, without moving the agents
+void ofApp::computeHeatmap()
+{
+  heatmap.clear();
+  heatmap.add(playback().timeline, heatmap_step);
+  heatmap_dirty = true;
+  flg_heatmap = true;
+}
+
+void ofApp::setupHeatmapShader()
+{
+  shaded_heatmap = false;
+
+  // the shaders are written for the fixed-function pipeline
+  if (ofIsGLProgrammableRenderer()) return;
+
+  if (!heatmap_shader.setupShaderFromSource(GL_VERTEX_SHADER, heatmap_vertex_shader)) return;
+  if (!heatmap_shader.setupShaderFromSource(GL_FRAGMENT_SHADER, heatmap_fragment_shader)) return;
+  if (!heatmap_shader.linkProgram()) return;
+
+  shaded_heatmap = true;
+}
+
+// under the graph, the cells are colored relative to the hottest one
+void ofApp::drawHeatmap()
+{
+  if (!flg_heatmap || heatmap.empty()) return;
+
+  const int w = heatmap.width, h = heatmap.height;
+  const float scale_heat = heatmap.max_heat > 0 ? 1/heatmap.max_heat : 0;
+  // the heat as it is, colored by the shader
+  if (heatmap_dirty && shaded_heatmap) {
+    heatmap_dirty = false;
+    if (!heatmap_texture.isAllocated() || heatmap_texture.getWidth() != w
+        || heatmap_texture.getHeight() != h) {
+      heatmap_texture.allocate(w, h, GL_R32F, false);
     }
-    else {
-      ofSetColor(Color::vertex);
+    heatmap_texture.loadData(heatmap.heat.data(), w, h, GL_RED);
+  }
+  else if (heatmap_dirty) {
+    heatmap_dirty = false;
+    heatmap_pixels.allocate(w, h, OF_PIXELS_RGBA);
+    for (int j = 0; j < h; ++j) {
+      // the screen is flipped w.r.t. the plan
+      const float* row = &heatmap.heat[size_t(h-1-j)*w];
+      for (int i = 0; i < w; ++i) {
+        const float a = row[i]*scale_heat;
+        ofColor color = heatmap_cold.getLerped(heatmap_hot, a);
+        color.a = a > 0 ? 64 + 160*a : 0;
+        heatmap_pixels.setColor(i, j, color);
+      }
+    }
+    if (!heatmap_texture.isAllocated() || heatmap_texture.getWidth() != w
+        || heatmap_texture.getHeight() != h) {
+      heatmap_texture.allocate(heatmap_pixels);
     }
-    ofDrawCircle(pos.x, pos.y, vertex_rad);
+    heatmap_texture.loadData(heatmap_pixels);
+  }
 
-    if (flg_font) {
-      ofSetColor(Color::font);
-      font.drawString(std::to_string(vid), pos.x - vertex_rad/2, pos.y - vertex_rad/2 + font_size);
+  const float x0 = heatmap.min_x, y0 = heatmap.min_y;
+  const Coord top_left = adjusted_pos(Coord{x0, y0 + h*heatmap.cell_size});
+  const Coord bottom_right = adjusted_pos(Coord{x0 + w*heatmap.cell_size, y0});
+
+  ofPushStyle();
+  ofEnableAlphaBlending();
+  ofSetColor(255);
+  if (shaded_heatmap) {
+    heatmap_shader.begin();
+    heatmap_shader.setUniformTexture("heat", heatmap_texture, 0);
+    heatmap_shader.setUniform1f("scale_heat", scale_heat);
+    const ofFloatColor cold = heatmap_cold, hot = heatmap_hot;
+    heatmap_shader.setUniform3f("cold", cold.r, cold.g, cold.b);
+    heatmap_shader.setUniform3f("hot", hot.r, hot.g, hot.b);
+  }
+  heatmap_texture.draw(top_left.x, top_left.y, bottom_right.x - top_left.x, bottom_right.y - top_left.y);
+  if (shaded_heatmap) heatmap_shader.end();
+  ofDisableAlphaBlending();
+  ofPopStyle();
+}
+
+void ofApp::buildPaths(int idx)
+{
+  const auto& timeline = playbacks[idx].timeline;
+  auto& p = paths[idx];
+  p.dirty = false;
+  p.vbo.clear();
+
+  // live plans grow, so each agent gets room for more segments
+  const bool live = idx == 0 && plan_socket.is_open();
+
+  const int n_agents = timeline.size();
+  p.first.assign(n_agents+1, 0);
+  paths_draw_first.clear();
+  paths_draw_count.clear();
+  paths_draw_first.reserve(n_agents);
+  paths_draw_count.reserve(n_agents);
+
+  Vector<glm::vec3> vertices;
+  Vector<ofFloatColor> colors;
+  for (int aid = 0; aid < n_agents; ++aid) {
+    auto& track = timeline.ctrack(aid);
+    const ofFloatColor color = agent_color(aid);
+    p.first[aid] = vertices.size();
+    for (size_t i = 1; i < track.size(); ++i) {
+      for (auto& w : {track[i-1], track[i]}) {
+        const Coord pos = adjusted_pos(Coord{w.x, w.y});
+        vertices.emplace_back(pos.x, pos.y, 0);
+        colors.push_back(color);
+      }
     }
+    if (!live) continue;
+    const size_t n_spare = 2*(track.size()/2 + paths_min_spare_segments);
+    vertices.resize(vertices.size() + n_spare);
+    colors.resize(colors.size() + n_spare, color);
   }
+  p.first[n_agents] = vertices.size();
+  if (vertices.empty()) return;
 
-  // this does not capture the gui panel, but if it does it works badly,
-  // it misses the sliders and the position is corrupt since it is not global but relative to the cam
-  if (flg_screenshot) {
-    ofEndSaveScreenAsPDF();
-    flg_screenshot = false;
+  const int usage = live ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+  p.vbo.setVertexData(vertices.data(), vertices.size(), usage);
+  p.vbo.setColorData(colors.data(), colors.size(), usage);
+}
+
+// the last segment of the track of the agent, just appended
+void ofApp::appendPath(int idx, Idx aid)
+{
+  auto& p = paths[idx];
+  if (p.dirty) return;
+
+  auto& track = playbacks[idx].timeline.ctrack(aid);
+  assert(track.size() >= 2);
+  const GLint first = p.first[aid] + 2*(track.size()-2);
+  // out of room, rebuilt with more
+  if (first+2 > p.first[aid+1]) {
+    p.dirty = true;
+    return;
   }
 
-  cam.end();
+  array<glm::vec3, 2> vertices;
+  const array<ofFloatColor, 2> colors{agent_color(aid), agent_color(aid)};
+  for (int i : {0, 1}) {
+    auto& w = track[track.size()-2+i];
+    const Coord pos = adjusted_pos(Coord{w.x, w.y});
+    vertices[i] = glm::vec3(pos.x, pos.y, 0);
+  }
+  p.vbo.getVertexBuffer().updateData(first*sizeof(glm::vec3), sizeof(vertices), vertices.data());
+  p.vbo.getColorBuffer().updateData(first*sizeof(ofFloatColor), sizeof(colors), colors.data());
+}
+
+void ofApp::drawPaths(int idx)
+{
+  if (line_mode != LINE_MODE::PATH && line_mode != LINE_MODE::STRAIGHT) return;
+  const auto& pb = playbacks[idx];
+  const auto& timeline = pb.timeline;
+  if (timeline.empty()) return;
+  auto& p = paths[idx];
+  // only the paths draw the buffer, it stays dirty until switched to them
+  if (line_mode == LINE_MODE::PATH && p.dirty) buildPaths(idx);
+
+  auto& heads = paths_heads_mesh;
+  heads.clear();
+  heads.setMode(OF_PRIMITIVE_LINES);
+  heads.setUsage(GL_STREAM_DRAW);
+  paths_draw_first.clear();
+  paths_draw_count.clear();
+
+  const int n_agents = timeline.size();
+  for (int aid = 0; aid < n_agents; ++aid) {
+    auto& track = timeline.ctrack(aid);
+    const Idx action_idx = pb.action_idx[aid];
+    if (action_idx+1 >= track.size()) continue;
+
+    // to the goal, or to the end of the current action and further
+    const auto& to = line_mode == LINE_MODE::STRAIGHT ? track.back() : track[action_idx+1];
+    const Coord pos = adjusted_pos_of_agent(pb, aid);
+    const Coord to_pos = adjusted_pos(Coord{to.x, to.y});
+    const ofFloatColor color = agent_color(aid);
+    heads.addVertex(glm::vec3(pos.x, pos.y, 0));
+    heads.addVertex(glm::vec3(to_pos.x, to_pos.y, 0));
+    heads.addColor(color);
+    heads.addColor(color);
+
+    if (line_mode != LINE_MODE::PATH) continue;
+    // the segments of the actions after the current one
+    const GLsizei count = 2*(track.size() - (action_idx+2));
+    if (count == 0) continue;
+    paths_draw_first.push_back(p.first[aid] + 2*(action_idx+1));
+    paths_draw_count.push_back(count);
+  }
+
+  ofSetLineWidth(line_width/2);
+  heads.draw();
+
+  if (paths_draw_first.empty()) return;
+  p.vbo.bind();
+  glMultiDrawArrays(GL_LINES, paths_draw_first.data(), paths_draw_count.data(), paths_draw_first.size());
+  p.vbo.unbind();
+}
+
+void ofApp::drawProfiler()
+{
+  if (!profiler.enabled) return;
+
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(2) << "phase       p50 ms  p99 ms\n";
+  for (size_t i = 0; i < Profiler::n_phases; ++i) {
+    const auto [p50, p99] = profiler.stats(Profiler::Phase(i));
+    oss << std::left << std::setw(10) << Profiler::phase_names[i] << std::right
+        << std::setw(8) << p50 << std::setw(8) << p99 << '\n';
+  }
+  const auto [sw50, sw99] = profiler.switches_stats();
+  oss << std::setprecision(0) << "switches  " << std::setw(8) << sw50 << std::setw(8) << sw99;
+
+  ofSetColor(Color::font_info);
+  ofDrawBitmapString(oss.str(), gui_panel.getPosition().x + gui_panel.getWidth() + 10,
+                     gui_panel.getPosition().y + 10);
+}
+
+void ofApp::drawCollisions(const Playback& pb)
+{
+  auto& collisions = pb.collisions;
+  if (!flg_collisions || collisions.empty()) return;
+
+  ofPushStyle();
+  ofSetColor(Color::collision);
+  ofSetLineWidth(line_width);
+  for (auto& [i, j] : collisions.pairs) {
+    const Coord pos_i = adjusted_pos_of_agent(pb, i);
+    const Coord pos_j = adjusted_pos_of_agent(pb, j);
+    ofDrawLine(pos_i.x, pos_i.y, pos_j.x, pos_j.y);
+  }
+
+  ofNoFill();
+  const int n_agents = agents.size();
+  for (int i = 0; i < n_agents; ++i) {
+    if (!collisions.colliding[i]) continue;
+    const Coord pos = adjusted_pos_of_agent(pb, i);
+    ofDrawCircle(pos.x, pos.y, scaled(agents[i].cradius()) + line_width);
+  }
+  ofPopStyle();
+}
+
+bool ofApp::drawingLabels() const
+{
+  if (!flg_font) return false;
+  // unreadable
+  return font_size*pixels_per_unit >= label_min_size_px;
+}
+
+// the same as `ofTrueTypeFont::drawString`, but with prepared glyphs
+void ofApp::drawLabelsMesh(ofVboMesh& mesh)
+{
+  if (mesh.getNumIndices() == 0) return;
+
+  const bool blending = glIsEnabled(GL_BLEND);
+  if (!blending) ofEnableAlphaBlending();
+  font.getFontTexture().bind();
+  mesh.draw();
+  font.getFontTexture().unbind();
+  if (!blending) ofDisableAlphaBlending();
+}
+
+void ofApp::buildAgentsLabels()
+{
+  agents_label_meshes.clear();
+  agents_labels_mesh.clear();
+  agents_labels_mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+  agents_labels_mesh.setUsage(GL_STREAM_DRAW);
+
+  agents_label_meshes.reserve(agents.size());
+  for (auto& ag : agents) {
+    agents_label_meshes.push_back(font.getStringMesh(std::to_string(ag.cid()),
+                                                     -font_size/2., font_size/2.));
+  }
+}
+
+void ofApp::drawAgentsLabels(const Playback& pb)
+{
+  if (!drawingLabels()) return;
+
+  const auto scope = profiler.scope(Profiler::Phase::labels);
+
+  auto& vertices = agents_labels_mesh.getVertices();
+  auto& tex_coords = agents_labels_mesh.getTexCoords();
+  auto& indices = agents_labels_mesh.getIndices();
+  vertices.clear();
+  tex_coords.clear();
+  indices.clear();
+
+  const int n_agents = agents.size();
+  for (int i = 0; i < n_agents; ++i) {
+    auto& ag = agents[i];
+    const Coord pos = adjusted_pos_of_agent(pb, ag.cid());
+    if (!visible(pos.x, pos.y, font_size*4)) continue;
+
+    auto& label = agents_label_meshes[i];
+    const ofIndexType offset = vertices.size();
+    const glm::vec3 shift(pos.x, pos.y, 0);
+    for (auto& v : label.getVertices()) vertices.push_back(v + shift);
+    tex_coords.insert(tex_coords.end(), label.getTexCoords().begin(), label.getTexCoords().end());
+    for (auto idx : label.getIndices()) indices.push_back(offset + idx);
+  }
+
+  ofSetColor(Color::font);
+  drawLabelsMesh(agents_labels_mesh);
+}
+
+void ofApp::setupCirclesShader()
+{
+  shaded_circles = false;
+
+  // the shaders are written for the fixed-function pipeline
+  if (ofIsGLProgrammableRenderer()) return;
+
+  if (!circles_shader.setupShaderFromSource(GL_VERTEX_SHADER, circles_vertex_shader)) return;
+  if (!circles_shader.setupShaderFromSource(GL_FRAGMENT_SHADER, circles_fragment_shader)) return;
+  circles_shader.bindAttribute(circles_offset_attribute, "instance_offset");
+  circles_shader.bindAttribute(circles_color_attribute, "instance_color");
+  if (!circles_shader.linkProgram()) return;
+
+  shaded_circles = true;
+}
+
+void ofApp::setupAgentsInstancing()
+{
+  instanced_agents = false;
+
+  if (agents.empty() || !shaded_circles) return;
+
+  // unit circle as a triangle fan
+  constexpr int res = agent_circle_resolution;
+  Vector<glm::vec3> circle;
+  circle.reserve(res+2);
+  circle.emplace_back(0, 0, 0);
+  for (int i = 0; i <= res; ++i) {
+    const float angle = TWO_PI*i/res;
+    circle.emplace_back(cos(angle), sin(angle), 0);
+  }
+  agents_vbo.setVertexData(circle.data(), circle.size(), GL_STATIC_DRAW);
+
+  const int n_agents = agents.size();
+  agents_colors.clear();
+  agents_colors.reserve(n_agents);
+  for (auto& ag : agents) agents_colors.emplace_back(agent_color(ag.cid()));
+  // only the visible agents are instanced, so the colors change too
+  agents_instance_colors = agents_colors;
+  agents_vbo.setAttributeData(circles_color_attribute, &agents_instance_colors[0].r, 4, n_agents,
+                              GL_STREAM_DRAW, sizeof(ofFloatColor));
+  agents_vbo.setAttributeDivisor(circles_color_attribute, 1);
+
+  agents_instances.resize(n_agents);
+  agents_vbo.setAttributeData(circles_offset_attribute, &agents_instances[0].x, 3, n_agents,
+                              GL_STREAM_DRAW, sizeof(glm::vec3));
+  agents_vbo.setAttributeDivisor(circles_offset_attribute, 1);
+
+  instanced_agents = true;
+}
+
+void ofApp::drawAgents(const Playback& pb)
+{
+  const auto scope = profiler.scope(Profiler::Phase::agents);
+  if (!instanced_agents) {
+    for (auto& ag : agents) {
+      auto& aid = ag.cid();
+      const Coord pos = adjusted_pos_of_agent(pb, aid);
+      const float r = scaled(ag.cradius());
+      if (!visible(pos.x, pos.y, r)) continue;
+      set_agent_color(aid);
+      ofDrawCircle(pos.x, pos.y, r);
+    }
+    return;
+  }
+
+  const int n_agents = agents.size();
+  int n_visible = 0;
+  for (int i = 0; i < n_agents; ++i) {
+    auto& ag = agents[i];
+    const Coord pos = adjusted_pos_of_agent(pb, ag.cid());
+    const float r = scaled(ag.cradius());
+    if (!visible(pos.x, pos.y, r)) continue;
+    agents_instances[n_visible] = glm::vec3(pos.x, pos.y, r);
+    agents_instance_colors[n_visible] = agents_colors[i];
+    ++n_visible;
+  }
+  if (n_visible == 0) return;
+  agents_vbo.updateAttributeData(circles_offset_attribute, &agents_instances[0].x, n_visible);
+  agents_vbo.updateAttributeData(circles_color_attribute, &agents_instance_colors[0].r, n_visible);
+
+  circles_shader.begin();
+  agents_vbo.drawInstanced(GL_TRIANGLE_FAN, 0, agents_vbo.getNumVertices(), n_visible);
+  circles_shader.end();
+}
+
+void ofApp::draw()
+{
+  // the same in all the viewports
+  updateView(viewport(0));
+
+  renderGraphLayers();
+
+  if (recording()) {
+    record_fbo.begin();
+    ofClear(Color::bg);
+  }
+
+  const int n_views = playbacks.size();
+  for (int i = 0; i < n_views; ++i) drawPlayback(i);
 
   if (!recording() || !gui_panel.isMinimized()) gui_panel.draw();
+  if (!recording()) drawProfiler();
 
   if (!recording()) return;
 
@@ -498,15 +1563,208 @@ void ofApp::draw()
   ofSetColor(Color::bg);
   record_fbo.draw(0, 0);
 
-  record_fbo.readToPixels(record_pixels);
-  assert(record_pixels.getWidth() > 0);
-  assert(record_pixels.getHeight() > 0);
-  assert(record_pixels.getBitsPerPixel() == 24);
-  gif_encoder.addFrame(record_pixels.getData(),
-                       record_pixels.getWidth(),
-                       record_pixels.getHeight(),
-                       record_pixels.getBitsPerPixel()
-  );
+  readRecordFrame();
+}
+
+void ofApp::drawPlayback(int idx)
+{
+  const auto& pb = playbacks[idx];
+  const bool split = playbacks.size() > 1;
+  const ofRectangle view = viewport(idx);
+  const bool layered = edges_fbo.isAllocated();
+
+  // otherwise into the current target, also of the recording
+  if (split) cam.begin(view);
+  else cam.begin();
+
+  // only of the first plan
+  if (idx == 0) drawHeatmap();
+
+  // draw edges
+  if (graph_l) {
+    if (layered) drawGraphLayer(edges_fbo, view);
+    else drawEdges();
+  }
+
+  drawPaths(idx);
+
+  // draw agents
+  drawAgents(pb);
+
+  // draw vertices
+  if (graph_l) {
+    if (layered) drawGraphLayer(vertices_fbo, view);
+    else drawVertices();
+  }
+
+  drawCollisions(pb);
+
+  drawAgentsLabels(pb);
+
+  cam.end();
+
+  if (!split) return;
+  ofSetColor(Color::font_info);
+  ofDrawBitmapString(pb.name, view.x + 10, view.getBottom() - 10);
+}
+
+// the graph is drawn only once per frame for all the viewports,
+// otherwise it would cost as many times as there are plans
+void ofApp::setupGraphLayers()
+{
+  if (!graph_l || playbacks.size() == 1) return;
+
+  const ofRectangle view = viewport(0);
+  edges_fbo.allocate(view.width, view.height, GL_RGBA);
+  vertices_fbo.allocate(view.width, view.height, GL_RGBA);
+}
+
+void ofApp::renderGraphLayers()
+{
+  if (!edges_fbo.isAllocated()) return;
+
+  const ofRectangle view = viewport(0);
+  const auto render = [&](ofFbo& fbo, auto draw_fn){
+    fbo.begin();
+    // transparent, the layers in between show through
+    ofClear(0, 0, 0, 0);
+    cam.begin(ofRectangle(0, 0, view.width, view.height));
+    (this->*draw_fn)();
+    cam.end();
+    fbo.end();
+  };
+  render(edges_fbo, &ofApp::drawEdges);
+  render(vertices_fbo, &ofApp::drawVertices);
+}
+
+// in screen coordinates, in between the camera
+void ofApp::drawGraphLayer(const ofFbo& fbo, const ofRectangle& view)
+{
+  cam.end();
+  ofPushStyle();
+  ofEnableAlphaBlending();
+  ofSetColor(255);
+  fbo.draw(view.x, view.y);
+  ofDisableAlphaBlending();
+  ofPopStyle();
+  cam.begin(view);
+}
+
+void ofApp::readRecordFrame()
+{
+  if (record_fn.empty()) {
+    record_fn = recordFileName();
+    if (Video_pipe::supports(record_fn)) {
+      video_pipe.open(record_fn, record_fbo.getWidth(), record_fbo.getHeight(),
+                      headless() ? render_config.fps : ofGetTargetFrameRate());
+    }
+  }
+
+  {
+    const auto scope = profiler.scope(Profiler::Phase::readback);
+    auto& pbo = record_pbos[record_n_read++ % record_buffers];
+    // rows are tightly packed, as the encoder expects
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // only queues the transfer, it does not wait for the GPU
+    record_fbo.copyTo(pbo);
+  }
+
+  // by now the older frames have finished transferring
+  while (record_n_read - record_n_added >= record_buffers) addRecordFrame();
+}
+
+void ofApp::addRecordFrame()
+{
+  const auto scope = profiler.scope(Profiler::Phase::encode);
+  assert(record_n_added < record_n_read);
+  auto& pbo = record_pbos[record_n_added++ % record_buffers];
+  // the encoder makes its own copy, directly from the mapped buffer
+  auto* data = pbo.map<unsigned char>(GL_READ_ONLY);
+  assert(data);
+  if (!Video_pipe::supports(record_fn)) {
+    gif_encoder.addFrame(data, record_fbo.getWidth(), record_fbo.getHeight(), 24);
+  }
+  // unless ffmpeg has failed
+  else if (video_pipe.is_open()) video_pipe.write(data);
+  pbo.unmap();
+}
+
+void ofApp::flushRecordFrames()
+{
+  while (record_n_added < record_n_read) addRecordFrame();
+  record_n_read = record_n_added = 0;
+}
+
+static Vector_image::Rgb rgb(const ofColor& color)
+{
+  return {color.r, color.g, color.b};
+}
+
+// the same scene as `draw`, without the gui
+Vector_image ofApp::makeVectorImage() const
+{
+  const auto [w, h] = window_size();
+  const auto [mx, my] = window_min();
+
+  Vector_image img;
+  img.width = w + mx*2;
+  img.height = h + my*2;
+  img.bg = rgb(Color::bg);
+
+  if (graph_l) {
+    auto& edges = img.layer("edges", rgb(Color::edge));
+    edges.line_width = line_width;
+    for (auto& vertex : graph().cvertices()) {
+      auto& vid = vertex.cid();
+      const Coord pos = adjusted_pos_of(vertex);
+      for (auto& nid : vertex.cneighbor_ids()) {
+        if (vid > nid) continue;
+        const Coord npos = adjusted_pos_of(graph().cvertex(nid));
+        edges.lines.push_back({float(pos.x), float(pos.y), float(npos.x), float(npos.y)});
+      }
+    }
+  }
+
+  for (auto& ag : agents) {
+    auto& aid = ag.cid();
+    const Coord pos = adjusted_pos_of_agent(playback(), aid);
+    img.layer("agents", rgb(agent_color(aid))).discs.push_back(
+      {float(pos.x), float(pos.y), float(scaled(ag.cradius()))}
+    );
+  }
+
+  if (!graph_l) return img;
+
+  // not from the graph layer, which may not have been set up
+  for (auto& vertex : graph().cvertices()) {
+    const Coord pos = adjusted_pos_of(vertex);
+    const agent::Id* aid_l = flg_goal ? plan.find_agent_id_of_goal(vertex.cid()) : nullptr;
+    const ofColor& color = aid_l ? agent_color(*aid_l) : Color::vertex;
+    img.layer("vertices", rgb(color)).discs.push_back({float(pos.x), float(pos.y), float(vertex_rad)});
+  }
+
+  if (!flg_font) return img;
+
+  auto& labels = img.layer("labels", rgb(Color::font));
+  labels.font_size = font_size;
+  for (auto& vertex : graph().cvertices()) {
+    const Coord pos = adjusted_pos_of(vertex);
+    labels.texts.push_back({float(pos.x - vertex_rad/2), float(pos.y - vertex_rad/2 + font_size),
+                            std::to_string(vertex.cid())});
+  }
+  for (auto& ag : agents) {
+    const Coord pos = adjusted_pos_of_agent(playback(), ag.cid());
+    labels.texts.push_back({float(pos.x - font_size/2.), float(pos.y + font_size/2.),
+                            std::to_string(ag.cid())});
+  }
+
+  return img;
+}
+
+void ofApp::saveVectorImage(const string& fn) const
+{
+  makeVectorImage().save(fn);
+  cout << "saved image as " << fn << endl;
 }
 
 void ofApp::onFinish()
@@ -523,11 +1781,53 @@ void ofApp::saveRecord()
   flg_record = false;
   recording_may_start = false;
 
-  const string fn = ofFilePath::getUserHomeDir()
-                  + "/Desktop/record-" + ofGetTimestampString()
-                  + ".gif";
-  cout << "saving gif as " << fn << " ..." << endl;
-  gif_encoder.save(fn);
+  // such as of an empty chunk
+  const bool recorded = record_n_read > 0;
+  flushRecordFrames();
+  const string fn = record_fn.empty() ? recordFileName() : move(record_fn);
+  record_fn.clear();
+
+  if (!Video_pipe::supports(fn)) {
+    cout << "saving gif as " << fn << " ..." << endl;
+    gif_fn = fn;
+    gif_encoder.save(fn);
+    return;
+  }
+
+  // the frames are already encoded, only the file is finalized
+  if (video_pipe.is_open() && video_pipe.close()) {
+    cout << "saved video as " << fn << endl;
+  }
+  else if (!recorded && !video_pipe.is_open()) {
+    cout << "no frames to save as " << fn << endl;
+  }
+  else {
+    cerr << "failed to save video as " << fn << endl;
+    *record_failed_l = true;
+  }
+}
+
+string ofApp::recordFileName() const
+{
+  if (headless()) return render_config.output;
+  return ofFilePath::getUserHomeDir()
+       + "/Desktop/record-" + ofGetTimestampString()
+       + "." + render_config.format;
+}
+
+void ofApp::dropRecord()
+{
+  gif_encoder.stop();
+  // gif_encoder.waitForThread();
+  gif_encoder.reset();
+
+  // the pending frames are dropped
+  record_n_read = record_n_added = 0;
+  if (video_pipe.is_open()) {
+    video_pipe.close();
+    ofFile::removeFile(record_fn, /*bRelativeToData*/ false);
+  }
+  record_fn.clear();
 }
 
 void ofApp::keyPressed(int key)
@@ -547,9 +1847,28 @@ void ofApp::keyPressed(int key)
   case 'l':
     flg_loop = !flg_loop;
     return;
+  case '+':
+  case '=':
+    return zoom(zoom_factor);
+  case '-':
+    return zoom(1/zoom_factor);
+  case 'x':
+    flg_collisions = !flg_collisions;
+    return;
+  case 't':
+    return profiler.enable(!profiler.enabled);
+  case 'z':
+    flg_collision_pause = !flg_collision_pause;
+    if (flg_collision_pause) flg_collisions = true;
+    return;
+  case 'h':
+    flg_heatmap = !flg_heatmap;
+    return;
+  case 'H':
+    return computeHeatmap();
   case 'g':
     flg_goal = !flg_goal;
-    return;
+    return updateGraphLayerColors();
   case 'f':
     flg_font = !flg_font;
     flg_font &= (scale - font_size > 6);
@@ -560,16 +1879,17 @@ void ofApp::keyPressed(int key)
   case OF_KEY_RIGHT:
     return doStep<StepMode::manual>(speed_slider);
   case OF_KEY_LEFT:
-    return doStep<StepMode::manual>(-speed_slider);
+    return seek(curr_time - speed_slider);
   case OF_KEY_UP:
     speed_slider = min<float>(speed_slider + 0.01, speed_slider.getMax());
     return;
   case OF_KEY_DOWN:
     speed_slider = max<float>(speed_slider - 0.01, speed_slider.getMin());
     return;
-  case 32:
-    flg_screenshot = true;  // space
-    return;
+  case 32:  // space
+    return saveVectorImage(ofFilePath::getUserHomeDir()
+                           + "/Desktop/screenshot-" + ofGetTimestampString()
+                           + ".pdf");
   case 'c':
     if (!flg_record) {
       flg_record = true;
@@ -595,12 +1915,24 @@ void ofApp::mouseEntered(int x, int y) {}
 
 void ofApp::mouseExited(int x, int y) {}
 
-void ofApp::windowResized(int w, int h) {}
+void ofApp::windowResized(int w, int h)
+{
+  // e.g. minimized
+  if (w <= 0 || h <= 0) return;
+  // the layers follow the viewports, they are rendered anew in the next frame
+  setupGraphLayers();
+}
 
 void ofApp::gotMessage(ofMessage msg) {}
 
 void ofApp::dragEvent(ofDragInfo dragInfo) {}
 
+void ofApp::onTimestepChanged(float& t)
+{
+  // the slider was dragged
+  if (t != curr_time) seek(t);
+}
+
 void ofApp::onGifSaved(string& fileName)
 {
   cout << "saved gif as " << fileName << endl;
@@ -612,4 +1944,12 @@ void ofApp::exit()
   ofBaseApp::exit();
 
   gif_encoder.waitForThread();
+
+  // the encoder does not report its failures
+  if (gif_fn.empty()) return;
+  if (!ofFile::doesFileExist(gif_fn, /*bRelativeToData*/ false)) {
+    cerr << "failed to save gif as " << gif_fn << endl;
+    *record_failed_l = true;
+  }
+  gif_fn.clear();
 }
@@ -0,0 +1,114 @@
+#include "../include/plan_cache.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <tomaqa.hpp>
+
+namespace plan_cache {
+  // FNV-1a, stable across runs and platforms
+  static constexpr uint64_t fnv_offset = 14695981039346656037ull;
+  static constexpr uint64_t fnv_prime = 1099511628211ull;
+
+  static void hash(uint64_t& h, const char* data, size_t size)
+  {
+    for (size_t i = 0; i < size; ++i) {
+      h ^= uint8_t(data[i]);
+      h *= fnv_prime;
+    }
+  }
+
+  static void hash_string(uint64_t& h, const std::string& str)
+  {
+    // the size separates the consecutive inputs
+    const uint64_t size = str.size();
+    hash(h, reinterpret_cast<const char*>(&size), sizeof(size));
+    hash(h, str.data(), str.size());
+  }
+
+  static std::string read_file(const std::string& path)
+  {
+    using namespace tomaqa;
+    using namespace std;
+
+    ifstream ifs(path, ios::binary);
+    expect(ifs, "File not readable: "s + path);
+    ostringstream oss;
+    oss << ifs.rdbuf();
+    return move(oss).str();
+  }
+
+  std::string dir()
+  {
+    using namespace std;
+
+    if (const char* xdg = getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+      return string(xdg) + "/mapf_r-visualizer";
+    }
+    const char* home = getenv("HOME");
+    return string(home ? home : ".") + "/.cache/mapf_r-visualizer";
+  }
+
+  Key make_key(const std::string& graph_path, const std::string& layout_path)
+  {
+    uint64_t h = fnv_offset;
+    hash_string(h, read_file(graph_path));
+    hash_string(h, read_file(layout_path));
+    hash_string(h, solver_id);
+    return h;
+  }
+
+  std::string path_of(Key key)
+  {
+    std::ostringstream oss;
+    oss << dir() << '/' << std::hex << std::setw(16) << std::setfill('0') << key << ".p";
+    return oss.str();
+  }
+
+  std::optional<agent::plan::Global> load(Key key)
+  {
+    std::ifstream ifs(path_of(key));
+    if (!ifs) return {};
+
+    try {
+      return agent::plan::Global(ifs);
+    }
+    catch (const Error& err) {
+      std::cerr << "Ignoring corrupted cached plan " << path_of(key) << ": " << err << std::endl;
+      return {};
+    }
+  }
+
+  void save(Key key, const agent::plan::Global& plan)
+  {
+    namespace fs = std::filesystem;
+    using namespace std;
+
+    const string path = path_of(key);
+    // written aside and renamed, so concurrent runs never read a partial plan
+    const string tmp_path = path + ".tmp" + to_string(::getpid());
+
+    error_code ec;
+    fs::create_directories(dir(), ec);
+    {
+      ofstream ofs(tmp_path);
+      if (ofs) ofs << plan;
+      if (!ofs) {
+        cerr << "Plan not cached, not writable: " << tmp_path << endl;
+        fs::remove(tmp_path, ec);
+        return;
+      }
+    }
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+      cerr << "Plan not cached: " << ec.message() << endl;
+      fs::remove(tmp_path, ec);
+    }
+  }
+}
@@ -0,0 +1,112 @@
+#include "../include/plan_socket.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <tomaqa.hpp>
+
+Plan_socket::~Plan_socket()
+{
+  if (is_open()) close();
+}
+
+void Plan_socket::open(const std::string& path_)
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  assert(!is_open());
+  path = path_;
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  expect(path.size() < sizeof(addr.sun_path), "Socket path too long: "s + path);
+  strcpy(addr.sun_path, path.c_str());
+
+  listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  expect(listen_fd >= 0, "Cannot create a socket: "s + strerror(errno));
+  // never an ordinary file given by mistake, binding fails on it instead
+  if (struct stat st; ::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+    ::unlink(path.c_str());
+  }
+  const bool bound = ::bind(listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+  if (!bound || ::listen(listen_fd, 1) != 0) {
+    const string err = strerror(errno);
+    // the file at the path is not ours to remove unless bound
+    ::close(listen_fd);
+    listen_fd = -1;
+    if (bound) ::unlink(path.c_str());
+    expect(false, "Cannot listen on socket "s + path + ": " + err);
+  }
+}
+
+void Plan_socket::close()
+{
+  assert(is_open());
+  if (client_fd >= 0) ::close(client_fd);
+  ::close(listen_fd);
+  ::unlink(path.c_str());
+  client_fd = listen_fd = -1;
+  buffer.clear();
+}
+
+void Plan_socket::poll(std::vector<Append>& appends)
+{
+  assert(is_open());
+
+  if (client_fd < 0) {
+    client_fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client_fd < 0) return;
+  }
+
+  char chunk[1 << 16];
+  while (true) {
+    const ssize_t n = ::read(client_fd, chunk, sizeof(chunk));
+    if (n > 0) {
+      buffer.append(chunk, n);
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+    if (n < 0 && errno == EINTR) continue;
+
+    // disconnected, the next client may connect
+    ::close(client_fd);
+    client_fd = -1;
+    break;
+  }
+
+  size_t begin = 0;
+  for (size_t end; (end = buffer.find('\n', begin)) != std::string::npos; begin = end+1) {
+    const std::string line = buffer.substr(begin, end - begin);
+    Append app;
+    if (parse(line, app)) appends.push_back(app);
+    else if (!line.empty()) std::cerr << "skipped plan line: " << line << std::endl;
+  }
+  buffer.erase(0, begin);
+  // the rest of the line is lost with the client
+  if (client_fd < 0) buffer.clear();
+}
+
+bool Plan_socket::parse(const std::string& line, Append& app)
+{
+  std::istringstream iss(line);
+  long long aid;
+  auto& w = app.waypoint;
+  if (!(iss >> aid >> w.t >> w.x >> w.y) || aid < 0) return false;
+  if (!std::isfinite(w.t) || !std::isfinite(w.x) || !std::isfinite(w.y)) return false;
+  // nothing else on the line
+  if (iss >> std::ws; !iss.eof()) return false;
+
+  app.aid = aid;
+  return true;
+}
@@ -0,0 +1,106 @@
+#include "../include/playback.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+
+[[maybe_unused]] static bool apx_equal(float a, float b)
+{
+  return std::abs(a - b) <= 1e-3f*std::max({1.f, std::abs(a), std::abs(b)});
+}
+
+void Playback::init()
+{
+  action_idx.assign(size(), 0);
+  motion.resize(size());
+  switch_events.clear();
+  switch_events.reserve(size());
+  collisions.pairs.clear();
+}
+
+void Playback::seek(float t)
+{
+  assert(action_idx.size() == size());
+
+  switch_events.clear();
+  for (Idx aid = 0; aid < size(); ++aid) {
+    const Idx idx = timeline.find(aid, t);
+    action_idx[aid] = idx;
+    motion.set(aid, timeline.ctrack(aid), idx, t);
+
+    if (const float t_end = timeline.end_time(aid, idx); t_end != t_inf) {
+      switch_events.emplace_back(t_end, aid);
+    }
+  }
+  std::ranges::make_heap(switch_events, std::greater<>());
+  update_switch_time_threshold();
+}
+
+void Playback::append(Idx aid, Timeline::Waypoint waypoint, float t)
+{
+  assert(action_idx.size() == size());
+
+  const bool staying = action_idx[aid]+1 == timeline.ctrack(aid).size();
+  timeline.append(aid, waypoint);
+  // the end of the current action is already scheduled
+  if (!staying) return;
+
+  const Idx idx = timeline.find(aid, t);
+  action_idx[aid] = idx;
+  motion.set(aid, timeline.ctrack(aid), idx, t);
+
+  if (const float t_end = timeline.end_time(aid, idx); t_end != t_inf) {
+    switch_events.emplace_back(t_end, aid);
+    std::ranges::push_heap(switch_events, std::greater<>());
+  }
+}
+
+Playback::Idx Playback::switch_actions()
+{
+  Idx n_switches = 0;
+  while (!switch_events.empty() && switch_events.front().first <= switch_time_threshold) {
+    std::ranges::pop_heap(switch_events, std::greater<>());
+    const Idx aid = switch_events.back().second;
+    switch_events.pop_back();
+    ++n_switches;
+
+    auto& track = timeline.ctrack(aid);
+    auto& curr_action_idx = action_idx[aid];
+    assert(curr_action_idx+1 < track.size());
+    assert(apx_equal(motion.x[aid], track[curr_action_idx+1].x));
+    assert(apx_equal(motion.y[aid], track[curr_action_idx+1].y));
+
+    ++curr_action_idx;
+    motion.set(aid, track, curr_action_idx, switch_time_threshold);
+
+    // zero-duration actions are switched within this same loop
+    if (const float t_end = timeline.end_time(aid, curr_action_idx); t_end != t_inf) {
+      switch_events.emplace_back(t_end, aid);
+      std::ranges::push_heap(switch_events, std::greater<>());
+    }
+  }
+
+  update_switch_time_threshold();
+  return n_switches;
+}
+
+void Playback::update_switch_time_threshold()
+{
+  if (switch_events.empty()) {
+    switch_time_threshold = makespan;
+    return;
+  }
+
+  switch_time_threshold = switch_events.front().first;
+  if (switch_time_threshold > makespan) {
+    assert(apx_equal(switch_time_threshold, makespan));
+    switch_time_threshold = makespan;
+  }
+}
+
+void Playback::detect_collisions()
+{
+  if (empty()) return collisions.pairs.clear();
+  collisions.detect(motion.x, motion.y, timeline.radii);
+}
@@ -0,0 +1,76 @@
+#include "../include/profiler.hpp"
+
+#include <algorithm>
+
+#include <tomaqa.hpp>
+
+static Profiler::Stats percentiles(std::vector<float> values)
+{
+  if (values.empty()) return {0, 0};
+  const auto at = [&values](float q){
+    auto it = values.begin() + std::min(values.size()-1, std::size_t(q*values.size()));
+    std::nth_element(values.begin(), it, values.end());
+    return *it;
+  };
+  return {at(0.5), at(0.99)};
+}
+
+void Profiler::enable(bool enable_)
+{
+  enabled = enable_;
+  curr_ms.fill(0);
+  curr_switches = 0;
+}
+
+void Profiler::open_trace(const std::string& path)
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  trace.open(path);
+  expect(trace.good(), "Trace file not writable: "s + path);
+  trace << "frame,time";
+  for (auto name : phase_names) trace << ',' << name << "_ms";
+  trace << ",switches\n";
+
+  enable(true);
+}
+
+void Profiler::add(Phase ph, Clock::duration d)
+{
+  curr_ms[std::size_t(ph)] += std::chrono::duration<double, std::milli>(d).count();
+}
+
+void Profiler::end_frame(float time)
+{
+  if (!enabled) return;
+
+  const std::size_t slot = n_frames % window;
+  for (std::size_t i = 0; i < n_phases; ++i) {
+    auto& h = history_ms[i];
+    if (h.size() < window) h.push_back(curr_ms[i]);
+    else h[slot] = curr_ms[i];
+  }
+  if (history_switches.size() < window) history_switches.push_back(curr_switches);
+  else history_switches[slot] = curr_switches;
+
+  if (trace.is_open()) {
+    trace << n_frames << ',' << time;
+    for (double ms : curr_ms) trace << ',' << ms;
+    trace << ',' << curr_switches << '\n';
+  }
+
+  ++n_frames;
+  curr_ms.fill(0);
+  curr_switches = 0;
+}
+
+Profiler::Stats Profiler::stats(Phase ph) const
+{
+  return percentiles(history_ms[std::size_t(ph)]);
+}
+
+Profiler::Stats Profiler::switches_stats() const
+{
+  return percentiles(history_switches);
+}
@@ -0,0 +1,32 @@
+#include "../include/progress_log.hpp"
+
+int Progress_log::Buf::overflow(int c)
+{
+  if (c == traits_type::eof()) return traits_type::not_eof(c);
+
+  forward.put(c);
+  if (c != '\n') {
+    line += c;
+    return c;
+  }
+
+  if (!line.empty()) {
+    std::lock_guard lock(mtx);
+    last_line = std::move(line);
+  }
+  line.clear();
+  return c;
+}
+
+Progress_log::Progress_log(std::ostream& forward)
+    : std::ostream(nullptr)
+    , buf(forward)
+{
+  rdbuf(&buf);
+}
+
+std::string Progress_log::last_line() const
+{
+  std::lock_guard lock(buf.mtx);
+  return buf.last_line;
+}
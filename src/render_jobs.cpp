@@ -0,0 +1,114 @@
+#include "../include/render_jobs.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <tomaqa.hpp>
+
+namespace render_jobs {
+  static pid_t spawn(const std::vector<std::string>& args)
+  {
+    using namespace tomaqa;
+
+    const pid_t pid = ::fork();
+    expect(pid >= 0, "Cannot fork a render job.");
+    if (pid > 0) return pid;
+
+    std::vector<char*> argv;
+    for (auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    ::execvp(argv[0], argv.data());
+    perror(argv[0]);
+    ::_exit(127);
+  }
+
+  static bool wait(pid_t pid)
+  {
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+
+  bool supports(const std::string& output)
+  {
+    const auto ext = std::filesystem::path(output).extension();
+    return ext == ".mp4" || ext == ".webm" || ext == ".mkv";
+  }
+
+  std::string part_path(const std::string& output, int chunk)
+  {
+    std::filesystem::path path(output);
+    const auto ext = path.extension();
+    path.replace_extension(".part" + std::to_string(chunk) + ext.string());
+    return path.string();
+  }
+
+  int run(const std::vector<std::string>& args, const std::string& output, int n_jobs)
+  {
+    namespace fs = std::filesystem;
+    using namespace std;
+
+    assert(!args.empty());
+    assert(supports(output));
+    assert(n_jobs > 1);
+
+    // the later options override the original ones in the workers
+    vector<pid_t> pids;
+    for (int i = 0; i < n_jobs; ++i) {
+      auto job_args = args;
+      job_args.insert(job_args.end(), {
+        "--render", part_path(output, i),
+        "--jobs", "1",
+        "--chunk", to_string(i) + "/" + to_string(n_jobs),
+      });
+      pids.push_back(spawn(job_args));
+    }
+
+    // a job fails also when its part is not saved, see `ofApp::saveRecord`
+    bool ok = true;
+    for (int i = 0; i < n_jobs; ++i) {
+      if (wait(pids[i])) continue;
+      cerr << "render job of chunk " << i << " failed" << endl;
+      ok = false;
+    }
+
+    // only a successful job of an empty chunk, if there are more jobs than frames,
+    // leaves no part
+    const string list_path = output + ".parts";
+    vector<string> parts;
+    {
+      ofstream list_ofs(list_path);
+      for (int i = 0; i < n_jobs; ++i) {
+        auto part = part_path(output, i);
+        if (!fs::exists(part)) continue;
+        list_ofs << "file '" << part << "'\n";
+        parts.push_back(move(part));
+      }
+    }
+
+    if (ok && !parts.empty()) {
+      ok = wait(spawn({"ffmpeg", "-hide_banner", "-loglevel", "error", "-y",
+                       "-f", "concat", "-safe", "0", "-i", list_path,
+                       "-c", "copy", output}));
+    }
+    else ok = false;
+
+    error_code ec;
+    fs::remove(list_path, ec);
+    for (auto& part : parts) fs::remove(part, ec);
+
+    if (!ok) {
+      cerr << "parallel rendering into " << output << " failed" << endl;
+      return 1;
+    }
+    cout << "rendered " << output << " by " << n_jobs << " jobs" << endl;
+    return 0;
+  }
+}
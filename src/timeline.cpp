@@ -0,0 +1,89 @@
+#include "../include/timeline.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+Timeline::Timeline(const Timeline& rhs)
+  : tracks(rhs.tracks), radii(rhs.radii), abs_vs(rhs.abs_vs),
+    storage(rhs.storage), external_storage(rhs.external_storage),
+    makespan(rhs.makespan)
+{
+  // the stored tracks are not empty, so their data identify them
+  std::unordered_map<const Waypoint*, Idx> storage_idx_of;
+  for (Idx i = 0; i < rhs.storage.size(); ++i) storage_idx_of[rhs.storage[i].data()] = i;
+
+  for (auto& track : tracks) {
+    const auto it = storage_idx_of.find(track.data());
+    // external tracks stay shared
+    if (it == storage_idx_of.end()) continue;
+    track = storage[it->second];
+  }
+}
+
+Timeline& Timeline::operator=(const Timeline& rhs)
+{
+  if (this != &rhs) *this = Timeline(rhs);
+  return *this;
+}
+
+void Timeline::clear()
+{
+  tracks.clear();
+  radii.clear();
+  abs_vs.clear();
+  storage.clear();
+  external_storage.reset();
+  makespan = 0;
+}
+
+void Timeline::add_track(std::vector<Waypoint> waypoints, float radius, float abs_v)
+{
+  // moving the vector keeps its data, so the views of the other tracks stay valid
+  auto& wps = storage.emplace_back(std::move(waypoints));
+  add_track_view(wps, radius, abs_v);
+}
+
+void Timeline::add_track_view(Track track, float radius, float abs_v)
+{
+  assert(!track.empty());
+  assert(std::is_sorted(track.begin(), track.end(),
+                        [](auto& lhs, auto& rhs){ return lhs.t < rhs.t; }));
+
+  makespan = std::max(makespan, track.back().t);
+  tracks.push_back(track);
+  radii.push_back(radius);
+  abs_vs.push_back(abs_v);
+}
+
+void Timeline::append(Idx aid, Waypoint waypoint)
+{
+  assert(aid < size());
+  // each track in the storage of the same index
+  assert(owned());
+  auto& wps = storage[aid];
+  assert(wps.data() == tracks[aid].data());
+  assert(waypoint.t >= wps.back().t);
+
+  wps.push_back(waypoint);
+  tracks[aid] = wps;
+  makespan = std::max(makespan, waypoint.t);
+}
+
+Timeline::Idx Timeline::find(Idx aid, float t) const
+{
+  auto& track = ctrack(aid);
+  assert(!track.empty());
+  auto it = std::upper_bound(track.begin(), track.end(), t,
+                             [](float t_, auto& wp){ return t_ < wp.t; });
+  if (it == track.begin()) return 0;
+  return (it - track.begin()) - 1;
+}
+
+float Timeline::end_time(Idx aid, Idx idx) const
+{
+  auto& track = ctrack(aid);
+  assert(idx < track.size());
+  if (idx+1 == track.size()) return t_inf;
+  return track[idx+1].t;
+}
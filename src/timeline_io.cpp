@@ -0,0 +1,177 @@
+#include "../include/timeline_io.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tomaqa.hpp>
+
+// fewer agents are not worth the threads
+static constexpr int make_timeline_parallel_min_size = 256;
+
+// the last idle state of infinite duration does not add a waypoint
+static std::vector<Timeline::Waypoint> make_track(const auto& states)
+{
+  std::vector<Timeline::Waypoint> track;
+  track.reserve(states.size()+1);
+
+  float t = 0;
+  const Coord start = states.front().cpos();
+  track.push_back({t, float(start.x), float(start.y)});
+  for (auto& st : states) {
+    const double d = st.cduration();
+    if (!std::isfinite(d)) break;
+    t += d;
+    const Coord pos = st.cend_pos();
+    track.push_back({t, float(pos.x), float(pos.y)});
+  }
+
+  return track;
+}
+
+Timeline make_timeline(const agent::plan::Global_states& splan)
+{
+  const int n_agents = splan.size();
+  // the tracks of agents are independent, only their order is kept
+  std::vector<std::vector<Timeline::Waypoint>> tracks(n_agents);
+  #pragma omp parallel for schedule(dynamic, 64) if(n_agents >= make_timeline_parallel_min_size)
+  for (int i = 0; i < n_agents; ++i) {
+    agent::Id aid = i;
+    tracks[i] = make_track(splan.cat(aid));
+  }
+
+  Timeline timeline;
+  timeline.tracks.reserve(n_agents);
+  timeline.radii.reserve(n_agents);
+  timeline.abs_vs.reserve(n_agents);
+  timeline.storage.reserve(n_agents);
+  for (int i = 0; i < n_agents; ++i) {
+    agent::Id aid = i;
+    auto& states = splan.cat(aid);
+    timeline.add_track(std::move(tracks[i]), states.radius, states.abs_v);
+  }
+
+  return timeline;
+}
+
+namespace spb {
+  std::size_t agents_offset()
+  {
+    return sizeof(Header);
+  }
+
+  std::size_t waypoints_offset(const Header& header)
+  {
+    return agents_offset() + header.n_agents*sizeof(Agent_record);
+  }
+
+  void check(const Header& header, std::size_t file_size, const std::string& path)
+  {
+    using namespace tomaqa;
+    using namespace std;
+
+    expect(file_size >= sizeof(Header), "Not a binary plan file: "s + path);
+    expect(memcmp(header.magic, magic, sizeof(magic)) == 0, "Not a binary plan file: "s + path);
+    expect(header.version == version, "Unsupported binary plan version: "s + to_string(header.version));
+    expect(file_size == waypoints_offset(header) + header.n_waypoints*sizeof(Timeline::Waypoint),
+           "Corrupted binary plan file: "s + path);
+  }
+
+  void check(const Agent_record& rec, const Header& header, const std::string& path)
+  {
+    using namespace tomaqa;
+    using namespace std;
+
+    expect(rec.size > 0 && rec.begin + rec.size <= header.n_waypoints,
+           "Corrupted binary plan file: "s + path);
+  }
+
+  Timeline load(const std::string& path)
+  {
+    using namespace tomaqa;
+    using namespace std;
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    expect(fd >= 0, "Plan file not readable: "s + path);
+    struct stat st;
+    const bool stat_ok = ::fstat(fd, &st) == 0;
+    const size_t size = stat_ok ? st.st_size : 0;
+    void* addr = size >= sizeof(Header) ? ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)
+                                        : MAP_FAILED;
+    // the mapping remains valid after closing
+    ::close(fd);
+    expect(addr != MAP_FAILED, "Plan file not mappable: "s + path);
+
+    Timeline timeline;
+    timeline.external_storage = shared_ptr<const void>(addr, [size](const void* p){
+      ::munmap(const_cast<void*>(p), size);
+    });
+
+    const auto* data = static_cast<const char*>(addr);
+    const auto& header = *reinterpret_cast<const Header*>(data);
+    check(header, size, path);
+
+    const size_t n_agents = header.n_agents;
+    const auto* records = reinterpret_cast<const Agent_record*>(data + agents_offset());
+    const auto* waypoints = reinterpret_cast<const Timeline::Waypoint*>(data + waypoints_offset(header));
+    timeline.tracks.reserve(n_agents);
+    for (size_t i = 0; i < n_agents; ++i) {
+      auto& rec = records[i];
+      check(rec, header, path);
+      timeline.add_track_view({waypoints + rec.begin, rec.size}, rec.radius, rec.abs_v);
+    }
+    assert(apx_equal(timeline.makespan, header.makespan));
+
+    return timeline;
+  }
+
+  void save(const Timeline& timeline, const std::string& path)
+  {
+    using namespace tomaqa;
+    using namespace std;
+
+    // written aside and renamed, so the processes that have the old file mapped
+    // keep their pages instead of getting SIGBUS on a truncated file
+    const string tmp_path = path + ".tmp" + to_string(::getpid());
+    ofstream ofs(tmp_path, ios::binary);
+    expect(ofs, "Plan file not writable: "s + tmp_path);
+
+    const size_t n_agents = timeline.size();
+    size_t n_waypoints = 0;
+    for (auto& track : timeline.tracks) n_waypoints += track.size();
+
+    Header header{};
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.n_agents = n_agents;
+    header.n_waypoints = n_waypoints;
+    header.makespan = timeline.makespan;
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    size_t begin = 0;
+    for (size_t i = 0; i < n_agents; ++i) {
+      auto& track = timeline.ctrack(i);
+      const Agent_record rec{begin, track.size(), timeline.radii[i], timeline.abs_vs[i]};
+      ofs.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+      begin += track.size();
+    }
+
+    for (auto& track : timeline.tracks) {
+      ofs.write(reinterpret_cast<const char*>(track.data()), track.size_bytes());
+    }
+
+    ofs.close();
+    error_code ec;
+    if (ofs) filesystem::rename(tmp_path, path, ec);
+    const bool written = ofs && !ec;
+    if (!written) filesystem::remove(tmp_path, ec);
+    expect(written, "Plan file not written: "s + path);
+  }
+}  // namespace spb
@@ -0,0 +1,129 @@
+#include "../include/timeline_stream.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tomaqa.hpp>
+
+static void read_at(int fd, void* buf, std::size_t size, std::size_t offset, const std::string& path)
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  auto* data = static_cast<char*>(buf);
+  while (size > 0) {
+    const ssize_t n = ::pread(fd, data, size, offset);
+    expect(n > 0, "Plan file not readable: "s + path);
+    data += n;
+    size -= n;
+    offset += n;
+  }
+}
+
+Timeline_stream::Timeline_stream(const std::string& path_, float window_duration_)
+    : path(path_)
+    , window_duration(window_duration_)
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  assert(window_duration > 0);
+
+  fd = ::open(path.c_str(), O_RDONLY);
+  expect(fd >= 0, "Plan file not readable: "s + path);
+  struct stat st;
+  expect(::fstat(fd, &st) == 0, "Plan file not readable: "s + path);
+  const size_t size = st.st_size;
+
+  if (size >= sizeof(header)) read_at(fd, &header, sizeof(header), 0, path);
+  spb::check(header, size, path);
+
+  // only the table of agents stays in memory
+  records.resize(header.n_agents);
+  read_at(fd, records.data(), records.size()*sizeof(spb::Agent_record), spb::agents_offset(), path);
+  for (auto& rec : records) spb::check(rec, header, path);
+}
+
+Timeline_stream::~Timeline_stream()
+{
+  if (prefetched.valid()) prefetched.wait();
+  if (fd >= 0) ::close(fd);
+}
+
+Timeline::Waypoint Timeline_stream::read_waypoint(Idx aid, Idx i) const
+{
+  auto& rec = records[aid];
+  assert(i < rec.size);
+  Timeline::Waypoint wp;
+  const size_t offset = spb::waypoints_offset(header) + (rec.begin + i)*sizeof(wp);
+  read_at(fd, &wp, sizeof(wp), offset, path);
+  return wp;
+}
+
+Timeline_stream::Window Timeline_stream::load(float t_begin, float t_end) const
+{
+  assert(t_begin <= t_end);
+
+  Window window;
+  window.begin = t_begin;
+  window.end = t_end >= makespan() ? Timeline::t_inf : t_end;
+
+  auto& timeline = window.timeline;
+  timeline.tracks.reserve(size());
+  const size_t n_agents = size();
+  for (size_t aid = 0; aid < n_agents; ++aid) {
+    auto& rec = records[aid];
+    // first waypoint after the time, by binary search over the file
+    auto find_after = [&](float t, Idx lo) {
+      Idx hi = rec.size;
+      while (lo < hi) {
+        const Idx mid = lo + (hi - lo)/2;
+        if (read_waypoint(aid, mid).t <= t) lo = mid+1;
+        else hi = mid;
+      }
+      return lo;
+    };
+
+    // the actions in progress at both bounds are included as a whole
+    const Idx after_begin = find_after(t_begin, 0);
+    const Idx first = after_begin > 0 ? after_begin-1 : 0;
+    const Idx last = std::min<Idx>(find_after(t_end, first), rec.size-1);
+
+    std::vector<Timeline::Waypoint> wps(last - first + 1);
+    const size_t offset = spb::waypoints_offset(header) + (rec.begin + first)*sizeof(Timeline::Waypoint);
+    read_at(fd, wps.data(), wps.size()*sizeof(Timeline::Waypoint), offset, path);
+    timeline.add_track(std::move(wps), rec.radius, rec.abs_v);
+  }
+
+  return window;
+}
+
+void Timeline_stream::prefetch(float t_begin, float t_end)
+{
+  if (prefetched.valid()) prefetched.wait();
+  prefetched = std::async(std::launch::async, [this, t_begin, t_end]{
+    return load(t_begin, t_end);
+  });
+}
+
+Timeline_stream::Window Timeline_stream::take(float t_begin, float t_end)
+{
+  Window window;
+  if (prefetched.valid()) window = prefetched.get();
+  if (!window.covers(t_begin, t_end)) {
+    window = load(t_begin, std::max(t_end, t_begin + window_duration));
+  }
+
+  // the windows overlap by a half,
+  // so that the next one also covers the steps across the boundary
+  if (window.end != Timeline::t_inf) {
+    const float next_begin = window.end - window_duration/2;
+    prefetch(next_begin, next_begin + window_duration);
+  }
+
+  return window;
+}
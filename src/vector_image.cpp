@@ -0,0 +1,170 @@
+#include "../include/vector_image.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <cairo.h>
+#include <cairo-pdf.h>
+
+#include <tomaqa.hpp>
+
+Vector_image::Layer& Vector_image::layer(const std::string& group, Rgb color)
+{
+  // the layers of a group are contiguous, so only the group is searched
+  auto rit = std::find_if(layers.rbegin(), layers.rend(), [&group](auto& l){
+    return l.group != group;
+  });
+  auto it = std::find_if(rit.base(), layers.end(), [color](auto& l){
+    return l.color == color;
+  });
+  if (it != layers.end()) return *it;
+
+  auto& l = layers.emplace_back();
+  l.group = group;
+  l.color = color;
+  return l;
+}
+
+void Vector_image::save(const std::string& path) const
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  const auto ext = filesystem::path(path).extension();
+  if (ext == ".svg") return save_svg(path);
+  if (ext == ".pdf") return save_pdf(path);
+  expect(false, "Unsupported image format: "s + path);
+}
+
+static std::string svg_color(Vector_image::Rgb c)
+{
+  char buf[8];
+  std::snprintf(buf, sizeof(buf), "#%02x%02x%02x", c.r, c.g, c.b);
+  return buf;
+}
+
+static std::string svg_escaped(const std::string& str)
+{
+  std::string res;
+  for (char c : str) {
+    switch (c) {
+    case '&': res += "&amp;"; break;
+    case '<': res += "&lt;"; break;
+    case '>': res += "&gt;"; break;
+    default: res += c;
+    }
+  }
+  return res;
+}
+
+void Vector_image::save_svg(const std::string& path) const
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  ofstream ofs(path);
+  expect(ofs, "Image file not writable: "s + path);
+
+  ofs << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+      << "\" viewBox=\"0 0 " << width << ' ' << height << "\">\n";
+  ofs << "<rect width=\"100%\" height=\"100%\" fill=\"" << svg_color(bg) << "\"/>\n";
+
+  const string* group_l = nullptr;
+  for (auto& l : layers) {
+    if (!group_l || *group_l != l.group) {
+      if (group_l) ofs << "</g>\n";
+      group_l = &l.group;
+      ofs << "<g id=\"" << svg_escaped(l.group) << "\">\n";
+    }
+    const string color = svg_color(l.color);
+
+    if (!l.lines.empty()) {
+      ofs << "<path fill=\"none\" stroke=\"" << color << "\" stroke-width=\"" << l.line_width
+          << "\" stroke-linecap=\"round\" d=\"";
+      for (auto& [x0, y0, x1, y1] : l.lines) {
+        ofs << 'M' << x0 << ' ' << y0 << 'L' << x1 << ' ' << y1;
+      }
+      ofs << "\"/>\n";
+    }
+
+    // a disc as two arcs
+    if (!l.discs.empty()) {
+      ofs << "<path fill=\"" << color << "\" d=\"";
+      for (auto& [x, y, r] : l.discs) {
+        ofs << 'M' << x - r << ' ' << y
+            << 'a' << r << ' ' << r << " 0 1 0 " << 2*r << " 0"
+            << 'a' << r << ' ' << r << " 0 1 0 " << -2*r << " 0z";
+      }
+      ofs << "\"/>\n";
+    }
+
+    if (!l.texts.empty()) {
+      ofs << "<g fill=\"" << color << "\" font-family=\"sans-serif\" font-size=\"" << l.font_size << "\">\n";
+      for (auto& [x, y, str] : l.texts) {
+        ofs << "<text x=\"" << x << "\" y=\"" << y << "\">" << svg_escaped(str) << "</text>\n";
+      }
+      ofs << "</g>\n";
+    }
+  }
+  if (group_l) ofs << "</g>\n";
+  ofs << "</svg>\n";
+
+  expect(ofs, "Image file not written: "s + path);
+}
+
+void Vector_image::save_pdf(const std::string& path) const
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  cairo_surface_t* surface = cairo_pdf_surface_create(path.c_str(), width, height);
+  expect(cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS, "Image file not writable: "s + path);
+  cairo_t* cr = cairo_create(surface);
+
+  const auto set_color = [cr](Rgb c){
+    cairo_set_source_rgb(cr, c.r/255., c.g/255., c.b/255.);
+  };
+
+  set_color(bg);
+  cairo_paint(cr);
+
+  cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+  cairo_select_font_face(cr, "sans-serif", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+  for (auto& l : layers) {
+    set_color(l.color);
+
+    if (!l.lines.empty()) {
+      for (auto& [x0, y0, x1, y1] : l.lines) {
+        cairo_move_to(cr, x0, y0);
+        cairo_line_to(cr, x1, y1);
+      }
+      cairo_set_line_width(cr, l.line_width);
+      cairo_stroke(cr);
+    }
+
+    if (!l.discs.empty()) {
+      for (auto& [x, y, r] : l.discs) {
+        cairo_new_sub_path(cr);
+        cairo_arc(cr, x, y, r, 0, 2*M_PI);
+      }
+      cairo_fill(cr);
+    }
+
+    if (!l.texts.empty()) {
+      cairo_set_font_size(cr, l.font_size);
+      for (auto& [x, y, str] : l.texts) {
+        cairo_move_to(cr, x, y);
+        cairo_show_text(cr, str.c_str());
+      }
+    }
+  }
+
+  cairo_destroy(cr);
+  cairo_surface_finish(surface);
+  const auto status = cairo_surface_status(surface);
+  cairo_surface_destroy(surface);
+  expect(status == CAIRO_STATUS_SUCCESS, "Image file not written: "s + path);
+}
@@ -0,0 +1,113 @@
+#include "../include/video_pipe.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <tomaqa.hpp>
+
+Video_pipe::~Video_pipe()
+{
+  if (is_open()) close();
+}
+
+bool Video_pipe::supports(const std::string& path)
+{
+  return !encoder_args(path).empty();
+}
+
+std::vector<std::string> Video_pipe::encoder_args(const std::string& path)
+{
+  const auto ext = std::filesystem::path(path).extension();
+  if (ext == ".mp4" || ext == ".mkv") {
+    return {"-c:v", "libx264", "-preset", "fast", "-crf", "20", "-pix_fmt", "yuv420p"};
+  }
+  if (ext == ".webm") {
+    return {"-c:v", "libvpx-vp9", "-b:v", "0", "-crf", "32", "-row-mt", "1"};
+  }
+  if (ext == ".apng") {
+    return {"-f", "apng", "-plays", "0"};
+  }
+  return {};
+}
+
+void Video_pipe::open(const std::string& path_, int width, int height, float fps)
+{
+  using namespace tomaqa;
+  using namespace std;
+
+  assert(!is_open());
+  assert(width > 0 && height > 0);
+  path = path_;
+  frame_size = size_t(width)*height*3;
+
+  const string size = to_string(width) + "x" + to_string(height);
+  vector<string> args{
+    "ffmpeg", "-hide_banner", "-loglevel", "error", "-y",
+    "-f", "rawvideo", "-pix_fmt", "rgb24", "-s", size, "-r", to_string(fps),
+    "-i", "-",
+  };
+  for (auto& arg : encoder_args(path)) args.push_back(arg);
+  args.push_back(path);
+
+  int fds[2];
+  expect(::pipe(fds) == 0, "Cannot create a pipe to ffmpeg.");
+  // a failed ffmpeg must not kill the visualizer
+  ::signal(SIGPIPE, SIG_IGN);
+
+  pid = ::fork();
+  expect(pid >= 0, "Cannot fork ffmpeg.");
+  if (pid == 0) {
+    ::dup2(fds[0], STDIN_FILENO);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    vector<char*> argv;
+    for (auto& arg : args) argv.push_back(arg.data());
+    argv.push_back(nullptr);
+    ::execvp(argv[0], argv.data());
+    perror("ffmpeg");
+    ::_exit(127);
+  }
+
+  ::close(fds[0]);
+  fd = fds[1];
+}
+
+bool Video_pipe::write(const unsigned char* rgb)
+{
+  assert(is_open());
+
+  size_t written = 0;
+  while (written < frame_size) {
+    const ssize_t n = ::write(fd, rgb + written, frame_size - written);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      std::cerr << "ffmpeg stopped accepting frames of " << path << std::endl;
+      close();
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+bool Video_pipe::close()
+{
+  assert(is_open());
+
+  // EOF on the input makes ffmpeg finish the file
+  ::close(fd);
+  fd = -1;
+
+  int status = 0;
+  while (::waitpid(pid, &status, 0) < 0 && errno == EINTR);
+  pid = -1;
+
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}